@@ -3,6 +3,10 @@
 
 #include "Configuration.h"
 
+// The settings are stored from EEPROM_OFFSET up to below this; anything else kept in the
+// EEPROM goes above it
+#define EEPROM_SETTINGS_END 512
+
 void Config_ResetDefault();
 
 #ifndef DISABLE_M503
@@ -227,6 +227,24 @@
 
 #define MAX_STEP_FREQUENCY 5000 // Max step frequency for Ultimaker (5000 pps / half step)
 
+// Stepper ISR profiler: time every stepper interrupt and keep duration histograms per path
+// (idle, block start, accelerate, cruise, decelerate, endstop hit), plus counts of late
+// interrupts and L6470 BSY wait timeouts.  M216 reports them, M216 R resets them.
+// Costs a few us per interrupt, so leave it off for production builds.
+//#define STEPPER_ISR_PROFILE
+
+// Work out the timer intervals of the acceleration and deceleration ramps in the main
+// loop, ahead of the stepper interrupt, so during the ramps the interrupt only looks
+// them up.  RAMP_TABLE_SIZE entries of 7 bytes each; must be a power of 2.
+#define STEPPER_RAMP_TABLE
+#define RAMP_TABLE_SIZE 16
+
+// Pulse every axis where its ideal step falls within the stepper interrupt interval,
+// instead of on the steps of the dominant axis, so minor axes step evenly.  Needs
+// STEP/DIR drivers (not USE_L6470); above 10kHz, with several steps per interrupt, axes
+// are pulsed as before.  Uses timer 1 compare B, so OC1B cannot be used for PWM.
+//#define INDEPENDENT_AXIS_TIMING
+
 //By default pololu step drivers require an active high signal. However, some high power drivers require an active low signal as step.
 #define INVERT_X_STEP_PIN false
 #define INVERT_Y_STEP_PIN false
@@ -281,6 +299,58 @@
 #define SD_FINISHED_STEPPERRELEASE true  //if sd support and the file is finished: disable steppers?
 #define SD_FINISHED_RELEASECOMMAND "M84 X Y Z E" // You might want to keep the z enabled so your bed stays in place.
 
+// Read the file being printed this many 512 byte blocks at a time into a buffer of its own,
+// rather than a byte at a time through the volume cache, which directory and FAT access
+// share.  Costs 512 bytes of RAM per block, which an 8KB AT90USB1286 can ill afford next
+// to the other buffers here, so it is off unless enabled.
+//#define SD_READAHEAD_BLOCKS 2
+
+// Read consecutive blocks of a file with one multiple block read (CMD18) left open between
+// reads, instead of a command and start token wait for every block (CMD17).  Any other
+// command to the card ends it first.  M36 S<blocks> times both kinds of read on the card.
+#define SD_READ_STREAM
+
+// Resolve the cluster chain of the file being printed into up to this many runs of
+// consecutive clusters when it is opened, so reading and seeking (M26, resume) need no
+// FAT access during the print.  6 bytes of RAM each; a chain with more runs reads the FAT
+// past the last one.  Comment out to follow the FAT.
+#define SD_EXTENTS 16
+
+// M35 <filename> uploads a file to SD as CRC checked binary chunks, acknowledged in a
+// window and written in whole blocks, instead of a line at a time through M28.  The
+// protocol is described at SD_UPLOAD_SYNC in cardreader.cpp.  Needs SD_READAHEAD_BLOCKS,
+// whose buffer it borrows.
+//#define SD_BINARY_UPLOAD
+
+// Journal the progress of SD prints to the EEPROM so a print that lost power can be
+// carried on with M1000: every PLR_INTERVAL the file offset of the last command whose
+// moves are done goes in, with the stepper positions, bed leveling, and the feedrate,
+// modes, temperatures and fan as they stood after that command.  M1000 lifts Z by
+// PLR_Z_LIFT, homes X and Y, heats up and picks up the file from there.  Z is not
+// homed, so the bed must not have moved while the power was off.
+//
+// A record is about 75 bytes and goes in the next slot of the journal, so each EEPROM
+// cell of it is written once in (PLR_EEPROM_SIZE - 142) / 75 records.  The EEPROM is
+// rated for 100,000 writes a cell: 3584 bytes last 4.7 million records, which at one
+// every 30 seconds is about 4.5 years of printing.  A shorter PLR_INTERVAL wears it out
+// sooner in proportion; a longer one loses more of the print to a power cut.
+#define POWER_LOSS_RESUME
+
+#ifdef POWER_LOSS_RESUME
+  #define PLR_EEPROM_SIZE 3584   // bytes at the top of the EEPROM, above the settings
+  #define PLR_INTERVAL 30000     // ms between records
+  #define PLR_Z_LIFT 2           // mm
+#endif
+
+// Index the working directory the first time the LCD or host browses it, so fetching
+// the n'th file reads its directory entry straight away instead of scanning the
+// directory up to it, and opening a file by name finds it without a scan.  Each entry
+// takes 5 bytes of RAM: a hash of the 8.3 name and where the entry is.  The index is
+// dropped when the card is mounted, the directory changes or a file is written or
+// deleted; files past the first SD_DIR_INDEX are still found by scanning.  The RAM is
+// taken for good, so it is off unless enabled; 32 entries cost 160 bytes.
+//#define SD_DIR_INDEX 32
+
 #define SDCARD_RATHERRECENTFIRST  //reverse file order of sd card menu display. Its sorted practically after the filesystem block order. 
 // if a file is deleted, it frees a block. hence, the order is not purely cronological. To still have auto0.g accessible, there is again the option to do that.
 // using:
@@ -296,6 +366,12 @@
 //#define WATCHDOG_RESET_MANUAL
 #endif
 
+// Sense endstops with pin interrupts instead of polling them on every stepper interrupt. The position is
+// latched when the switch closes and the stepper interrupt only checks a flag. Applies to axes whose stop
+// pin has an interrupt (*_STOP_INT = external interrupt number, *_STOP_PCINT = PCINT number on port B,
+// set in pins.h); the other axes are still polled.
+#define ENDSTOP_INTERRUPTS
+
 // Enable the option to stop SD printing when hitting and endstops, needs to be enabled from the LCD menu when this option is enabled.
 //#define ABORT_ON_ENDSTOP_HIT_FEATURE_ENABLED
 
@@ -373,6 +449,32 @@ const unsigned int dropsegments=5; //everything with less than this number of st
 // Control heater 0 and heater 1 in parallel.
 //#define HEATERS_PARALLEL
 
+// L6470 step verification: periodically compare each L6470's ABS_POS register with the
+// position the firmware thinks it commanded, and report steps the driver did not make.
+// Only used on boards with L6470 drivers.  M214 changes these settings at runtime.
+#define L6470_STEP_VERIFY
+#ifdef L6470_STEP_VERIFY
+  #define L6470_VERIFY_INTERVAL  500  // ms between checks
+  #define L6470_VERIFY_TOLERANCE  64  // microsteps of drift ignored (MOVEs still in flight)
+  #define L6470_VERIFY_ACTION      0  // 0 = report only, 1 = also pause an SD print, 2 = pause and re-home X and Y
+#endif
+
+// L6470 health monitor: poll the STATUS register of each driver and count undervoltage,
+// thermal warning/shutdown, overcurrent and stall events.  M215 reports the counters.
+#define L6470_HEALTH_MONITOR
+#ifdef L6470_HEALTH_MONITOR
+  #define L6470_HEALTH_INTERVAL 1000  // ms between STATUS polls
+  #define L6470_HEALTH_ACTION      0  // 0 = log only, 1 = also slow down, 2 = slow down and pause an SD print on a fault
+  #define L6470_HEALTH_SLOWDOWN   50  // feedrate percentage applied by action 1
+#endif
+
+// L6470 step granularity.  The drivers stay in 1/64 microstepping and get a MOVE of *_L6470_NSTEPS
+// microsteps per step.  Once the MOVEs for a block's moving axes would take more than L6470_SPI_BUDGET
+// percent of the time between stepper interrupts, each interrupt takes 2, 4, ... steps at once (at most
+// 1 << L6470_MAX_STEP_SHIFT) and sends them as a single MOVE.  The cost of a MOVE is measured at startup.
+#define L6470_SPI_BUDGET         50
+#define L6470_MAX_STEP_SHIFT      2
+
 //===========================================================================
 //=============================Buffers           ============================
 //===========================================================================
@@ -388,7 +490,46 @@ const unsigned int dropsegments=5; //everything with less than this number of st
 
 //The ASCII buffer for recieving from the serial:
 #define MAX_CMD_SIZE 96
-#define BUFSIZE 4
+// Lines are queued back to back with comments stripped, so short lines take little room:
+// CMD_QUEUE_SIZE bytes hold about a dozen typical moves.  BUFSIZE caps the number of lines.
+#define CMD_QUEUE_SIZE 384
+#define BUFSIZE 16
+
+// Append the last accepted line number, free planner blocks and free command buffer
+// slots to every "ok" ("ok N123 P14 B3"), so a host can keep several lines in flight
+// instead of waiting for each acknowledgement.  Once CMD_QUEUE_SIZE is used up, further
+// lines wait in the serial receive buffer.
+//#define ADVANCED_OK
+
+// Accept compact binary move frames (G0/G1 with CRC-16) on the serial line once the host
+// sends M217 S1.  ASCII lines still work in between; see BIN_FRAME_SYNC in Marlin_main.cpp.
+#define BINARY_PROTOCOL
+
+// Let the host queue blocks it has planned itself as binary frames once it sends M217 S2.
+// They bypass the planner but are checked against the speed, acceleration, jerk, extrusion
+// and software endstop limits; one that fails them stops the printer until M999, which
+// asks for it again.  The host must slow down at the end of each run of blocks:
+// the planner neither changes nor plans across them, so if the buffer runs dry the last
+// one stops at its final rate.
+#define PREPLANNED_BLOCKS
+
+// M155 S<seconds> makes the firmware send temperatures, position, planner and command queue
+// fill and SD progress on its own at that interval, so a host need not poll for them.
+#define AUTO_REPORT
+
+// M156 S<Hz> makes the firmware send a fixed-format binary status frame with a CRC at that
+// rate: raw temperatures and heater PWM, planner and queue fill, stepper ISR load, step
+// counts and L6470 status.  The layout is documented at TELEMETRY_SYNC in Marlin_main.cpp.
+// A frame that does not fit in the transmit buffer is dropped rather than waited for.
+#define BINARY_TELEMETRY
+#define TELEMETRY_MAX_HZ 50
+
+// Transmit buffer for the serial port.  Output is queued and sent from the UART data
+// register empty interrupt or, on AT90USB, handed to the USB serial a packet at a time
+// from the main loop, so printing no longer stalls planning and heater control.  When
+// it is full, writing waits for room.  Power of 2, at most 256; comment out to write
+// straight to the port.
+#define TX_BUFFER_SIZE 128
 
 
 // Firmware based and LCD controled retract
@@ -22,6 +22,17 @@
 #include "Configuration.h"
 #include "pins.h"
 
+// Features that need L6470 drivers
+#if !defined(USE_L6470) || (USE_L6470 == 0)
+  #undef L6470_STEP_VERIFY
+  #undef L6470_HEALTH_MONITOR
+#endif
+
+// Features that need an SD card
+#ifndef SDSUPPORT
+  #undef POWER_LOSS_RESUME
+#endif
+
 #ifndef AT90USB
 #define  HardwareSerial_h // trick to disable the standard HWserial
 #endif
@@ -52,6 +63,8 @@
 #ifdef AT90USB
    #ifdef BTENABLED
          #define MYSERIAL bt
+   #elif defined(USB_TX_BUFFER)
+         #define MYSERIAL MSerial
    #else
          #define MYSERIAL Serial
    #endif // BTENABLED
@@ -191,6 +204,7 @@ enum AxisEnum {X_AXIS=0, Y_AXIS=1, Z_AXIS=2, E_AXIS=3};
 
 void FlushSerialRequestResend();
 void ClearToSend();
+void SendOk(uint8_t queued);
 
 void get_coordinates();
 #ifdef DELTA
@@ -32,6 +32,10 @@
   ring_buffer rx_buffer  =  { { 0 }, 0, 0 };
 #endif
 
+#if defined(TX_BUFFER_SIZE) && UART_PRESENT(SERIAL_PORT)
+  tx_ring_buffer tx_buffer = { { 0 }, 0, 0 };
+#endif
+
 FORCE_INLINE void store_char(unsigned char c)
 {
   int i = (unsigned int)(rx_buffer.head + 1) % RX_BUFFER_SIZE;
@@ -58,6 +62,23 @@ FORCE_INLINE void store_char(unsigned char c)
   }
 #endif
 
+#if defined(TX_BUFFER_SIZE) && defined(M_USARTx_UDRE_vect)
+// Send the next queued byte; the interrupt goes off when the queue runs empty
+FORCE_INLINE void tx_udr_empty()
+{
+  uint8_t t = tx_buffer.tail;
+  M_UDRx = tx_buffer.buffer[t];
+  tx_buffer.tail = t = (t + 1) & (TX_BUFFER_SIZE - 1);
+  if (t == tx_buffer.head)
+    cbi(M_UCSRxB, M_UDRIEx);
+}
+
+ISR(M_USARTx_UDRE_vect)
+{
+  tx_udr_empty();
+}
+#endif
+
 // Constructors ////////////////////////////////////////////////////////////////
 
 MarlinSerial::MarlinSerial()
@@ -103,8 +124,50 @@ void MarlinSerial::end()
   cbi(M_UCSRxB, M_RXENx);
   cbi(M_UCSRxB, M_TXENx);
   cbi(M_UCSRxB, M_RXCIEx);  
+#ifdef TX_BUFFER_SIZE
+  cbi(M_UCSRxB, M_UDRIEx);
+#endif
 }
 
+#ifdef TX_BUFFER_SIZE
+void MarlinSerial::write(uint8_t c)
+{
+  // With nothing queued and the data register free, skip the queue
+  bool empty;
+  {
+    CRITICAL_SECTION_START;
+    empty = (tx_buffer.head == tx_buffer.tail);
+    if (empty && (M_UCSRxA & (1 << M_UDREx))) {
+      M_UDRx = c;
+      CRITICAL_SECTION_END;
+      return;
+    }
+    CRITICAL_SECTION_END;
+  }
+
+  uint8_t i = (tx_buffer.head + 1) & (TX_BUFFER_SIZE - 1);
+  // Full: wait for the interrupt to make room, or make it here if interrupts are off
+  while (i == tx_buffer.tail) {
+    if (!(SREG & (1 << SREG_I)) && (M_UCSRxA & (1 << M_UDREx)))
+      tx_udr_empty();
+  }
+
+  CRITICAL_SECTION_START;
+  tx_buffer.buffer[tx_buffer.head] = c;
+  tx_buffer.head = i;
+  sbi(M_UCSRxB, M_UDRIEx);
+  CRITICAL_SECTION_END;
+}
+
+void MarlinSerial::flushTX()
+{
+  while (tx_buffer.head != tx_buffer.tail) {
+    if (!(SREG & (1 << SREG_I)) && (M_UCSRxA & (1 << M_UDREx)))
+      tx_udr_empty();
+  }
+}
+#endif
+
 
 
 int MarlinSerial::peek(void)
@@ -321,6 +384,57 @@ MarlinSerial MSerial;
 #endif // whole file
 #endif // !AT90USB
 
+#ifdef USB_TX_BUFFER
+#if ARDUINO >= 100
+size_t MarlinUSBSerial::write(uint8_t c)
+#else
+void MarlinUSBSerial::write(uint8_t c)
+#endif
+{
+  // Interrupt code prints too (rarely), so keep the queue consistent
+  CRITICAL_SECTION_START;
+  uint8_t i = (tx_head + 1) & (TX_BUFFER_SIZE - 1);
+  if (i == tx_tail) {
+    // Full: send the queue the old way, waiting on the host if need be
+    CRITICAL_SECTION_END;
+    flushTX();
+    {
+      CRITICAL_SECTION_START;
+      i = (tx_head + 1) & (TX_BUFFER_SIZE - 1);
+      tx_buf[tx_head] = c;
+      tx_head = i;
+      CRITICAL_SECTION_END;
+    }
+  }
+  else {
+    tx_buf[tx_head] = c;
+    tx_head = i;
+    CRITICAL_SECTION_END;
+  }
+#if ARDUINO >= 100
+  return 1;
+#endif
+}
+
+void MarlinUSBSerial::drain()
+{
+  uint8_t t = tx_tail, h = tx_head;
+  if (h == t) return;
+  // The part up to the end of the ring or the head, at most a packet
+  unsigned short n = (h > t ? h : TX_BUFFER_SIZE) - t;
+  if (n > USB_TX_PACKET) n = USB_TX_PACKET;
+  Serial.write(&tx_buf[t], n);
+  tx_tail = (t + n) & (TX_BUFFER_SIZE - 1);
+}
+
+void MarlinUSBSerial::flushTX()
+{
+  while (tx_head != tx_tail) drain();
+}
+
+MarlinUSBSerial MSerial;
+#endif // USB_TX_BUFFER
+
 // For AT90USB targets use the UART for BT interfacing
 #if defined(AT90USB) && defined (BTENABLED)
    HardwareSerial bt;
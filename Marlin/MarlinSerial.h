@@ -55,6 +55,8 @@
 #define M_RXCx SERIAL_REGNAME(RXC,SERIAL_PORT,)
 #define M_USARTx_RX_vect SERIAL_REGNAME(USART,SERIAL_PORT,_RX_vect)
 #define M_U2Xx SERIAL_REGNAME(U2X,SERIAL_PORT,)
+#define M_UDRIEx SERIAL_REGNAME(UDRIE,SERIAL_PORT,)
+#define M_USARTx_UDRE_vect SERIAL_REGNAME(USART,SERIAL_PORT,_UDRE_vect)
 
 
 
@@ -84,6 +86,24 @@ struct ring_buffer
   extern ring_buffer rx_buffer;
 #endif
 
+#ifdef TX_BUFFER_SIZE
+#if (TX_BUFFER_SIZE > 256) || (TX_BUFFER_SIZE & (TX_BUFFER_SIZE - 1))
+  #error TX_BUFFER_SIZE must be a power of 2 no larger than 256
+#endif
+// Transmit ring buffer, emptied by the data register empty interrupt
+struct tx_ring_buffer
+{
+  unsigned char buffer[TX_BUFFER_SIZE];
+  volatile uint8_t head;
+  volatile uint8_t tail;
+};
+
+#if UART_PRESENT(SERIAL_PORT)
+  extern tx_ring_buffer tx_buffer;
+#endif
+#define SERIAL_TX_BUFFER
+#endif
+
 class MarlinSerial //: public Stream
 {
 
@@ -100,6 +120,11 @@ class MarlinSerial //: public Stream
       return (unsigned int)(RX_BUFFER_SIZE + rx_buffer.head - rx_buffer.tail) % RX_BUFFER_SIZE;
     }
     
+#ifdef TX_BUFFER_SIZE
+    void write(uint8_t c);
+    void flushTX(void);   // Wait until everything queued has gone out
+    FORCE_INLINE uint8_t txRoom(void) { return (tx_buffer.tail - tx_buffer.head - 1) & (TX_BUFFER_SIZE - 1); }
+#else
     FORCE_INLINE void write(uint8_t c)
     {
       while (!((M_UCSRxA) & (1 << M_UDREx)))
@@ -107,6 +132,7 @@ class MarlinSerial //: public Stream
 
       M_UDRx = c;
     }
+#endif
     
     
     FORCE_INLINE void checkRx(void)
@@ -181,6 +207,46 @@ class MarlinSerial //: public Stream
 extern MarlinSerial MSerial;
 #endif // !AT90USB
 
+// On AT90USB the host port is the USB CDC Serial of the core.  Writing that a byte
+// at a time costs an endpoint handshake per byte and waits whenever the host is
+// slow to poll, so queue the output here and hand it over a USB packet at a time
+// from the main loop (drain(), called by manage_inactivity()).
+#if defined(AT90USB) && defined(TX_BUFFER_SIZE) && !defined(BTENABLED)
+#if (TX_BUFFER_SIZE > 256) || (TX_BUFFER_SIZE & (TX_BUFFER_SIZE - 1))
+  #error TX_BUFFER_SIZE must be a power of 2 no larger than 256
+#endif
+#define USB_TX_PACKET 64   // Full speed bulk endpoint size
+
+class MarlinUSBSerial : public Print
+{
+  public:
+    FORCE_INLINE void begin(long baud) { Serial.begin(baud); }
+    FORCE_INLINE int available(void) { return Serial.available(); }
+    FORCE_INLINE int peek(void) { return Serial.peek(); }
+    FORCE_INLINE int read(void) { return Serial.read(); }
+    FORCE_INLINE void flush(void) { Serial.flush(); }
+
+#if ARDUINO >= 100
+    size_t write(uint8_t c);
+#else
+    void write(uint8_t c);
+#endif
+    using Print::write;
+
+    void drain(void);     // Hand the next packet to the USB serial
+    void flushTX(void);   // Hand over everything queued
+    FORCE_INLINE uint8_t txRoom(void) { return (tx_tail - tx_head - 1) & (TX_BUFFER_SIZE - 1); }  // bytes that fit without waiting
+
+  private:
+    unsigned char tx_buf[TX_BUFFER_SIZE];
+    uint8_t tx_head, tx_tail;
+};
+
+extern MarlinUSBSerial MSerial;
+#define SERIAL_TX_BUFFER
+#define USB_TX_BUFFER
+#endif
+
 // Use the UART for BT in AT90USB configurations
 #if defined(AT90USB) && defined (BTENABLED)
    extern HardwareSerial bt;
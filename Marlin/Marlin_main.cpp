@@ -45,6 +45,7 @@
 #include "watchdog.h"
 #include "ConfigurationStore.h"
 #include "language.h"
+#include "powerloss.h"
 #include "pins_arduino.h"
 #include "math.h"
 
@@ -65,6 +66,10 @@
 #include "stepper_l6470.h" // for enable_() and disable_() calls
 #endif
 
+#if defined(BINARY_PROTOCOL) || defined(BINARY_TELEMETRY)
+#include <util/crc16.h>
+#endif
+
 #define VERSION_STRING  "1.0.0"
 
 // look here for descriptions of gcodes: http://linuxcnc.org/handbook/gcode/g-code.html
@@ -107,6 +112,8 @@
 //        syntax "M32 /path/filename#", or "M32 S<startpos bytes> !filename#"
 //        Call gcode file : "M32 P !filename#" and return to caller file after finishing (simiarl to #include).
 //        The '#' is necessary when calling from within sd files, as it stops buffer prereading
+// M35  - Upload a file to SD as binary chunks (M35 filename.g, SD_BINARY_UPLOAD)
+// M36  - Time reading S<blocks> from SD one block at a time and as a stream (SD_READ_STREAM)
 // M42  - Change pin status via gcode Use M42 Px Sy to set pin x to value y, when omitting Px the onboard led will be used.
 // M80  - Turn on Power Supply
 // M81  - Turn off Power Supply
@@ -132,6 +139,8 @@
 // M129 - EtoP Closed (BariCUDA EtoP = electricity to air pressure transducer by jmil)
 // M140 - Set bed target temp
 // M150 - Set BlinkM Colour Output R: Red<0-255> U(!): Green<0-255> B: Blue<0-255> over i2c, G for green does not work.
+// M155 - S<seconds> report temperatures, position and queue state every S seconds, at most 60 (AUTO_REPORT). S0 stops it.
+// M156 - S<Hz> send binary telemetry frames at that rate (BINARY_TELEMETRY). S0 stops them.
 // M190 - Sxxx Wait for bed current temp to reach target temp. Waits only when heating
 //        Rxxx Wait for bed current temp to reach target temp. Waits when heating and cooling
 // M200 - Set filament diameter
@@ -148,6 +157,10 @@
 // M211 - set travel soft maximum
 // M212 - Set probe offset for bed leveling
 // M213 - Set motor holding currents (percentage duty cycles)
+// M214 - L6470 step verification: S<1=on/0=off> P<interval ms> T<tolerance microsteps> A<action> R (resync). Reports the drift.
+// M215 - L6470 health: P<poll interval ms> A<action> R (reset counters). Reports STATUS and event counters per driver.
+// M216 - Report the stepper ISR profile (STEPPER_ISR_PROFILE). R resets it.
+// M217 - S<1=on/0=off> accept binary move frames on the serial line (BINARY_PROTOCOL). S2 also accepts host-planned blocks (PREPLANNED_BLOCKS).
 // M218 - set hotend offset (in mm): T<extruder_number> X<offset_on_X> Y<offset_on_Y>
 // M220 S<factor in percent>- set speed factor override percentage
 // M221 S<factor in percent>- set extrude factor override percentage
@@ -179,6 +192,7 @@
 // M351 - Toggle MS1 MS2 pins directly.
 // M928 - Start SD logging (M928 filename.g) - ended by M29
 // M999 - Restart after being stopped by error
+// M1000 - Resume the SD print that was cut off by a power loss (POWER_LOSS_RESUME)
 
 //Stepper Movement Variables
 
@@ -269,17 +283,77 @@ static long gcode_N, gcode_LastN, Stopped_gcode_LastN = 0;
 
 static bool relative_mode = false;  //Determines Absolute or Relative Coordinates
 
-static char cmdbuffer[BUFSIZE][MAX_CMD_SIZE];
-static bool fromsd[BUFSIZE];
-static int bufindr = 0;
-static int bufindw = 0;
-static int buflen = 0;
+// Command queue.  Lines are kept back to back in one byte ring: a header byte holding
+// the length and CMD_QUIET, then the text and its terminating 0.  A 0 header, or the end
+// of the ring, sends the reader back to the start, so a line never wraps and is parsed
+// in place.  The line being received is built up behind the last queued one.
+#if MAX_CMD_SIZE > 128
+  #error MAX_CMD_SIZE must be 128 or less
+#endif
+#if CMD_QUEUE_SIZE < MAX_CMD_SIZE + 2
+  #error CMD_QUEUE_SIZE must hold at least one line of MAX_CMD_SIZE
+#endif
+#define CMD_LENGTH 0x7f
+#define CMD_QUIET  0x80 // read from SD or queued by the firmware itself: no "ok"
+static char cmdbuffer[CMD_QUEUE_SIZE];
+static int bufindr = 0; // header of the command being executed
+static int bufindw = 0; // header of the line being received
+static int buflen = 0;  // number of queued commands
+#ifdef POWER_LOSS_RESUME
+// For each queued command in turn, the SD file offset behind it, or 0 if it is not from
+// the SD card; the planner tags the moves with it for the power loss journal
+static unsigned long cmd_sdpos[BUFSIZE];
+static uint8_t cmd_sdpos_r = 0;          // of the command being executed
+static unsigned long cmd_queue_sdpos = 0; // for the line being queued
+#endif
 //static int i = 0;
 static char serial_char;
 static int serial_count = 0;
 static boolean comment_mode = false;
 static char *strchr_pointer; // just a pointer to find chars in the cmd string like X, Y, Z, E, etc
 
+// Where each letter A-Z first occurs in a line, plus the checksum '*' and the XOR of the
+// characters before it, found in one pass so that looking up a parameter needs no scan
+#define CMD_PARAM_NONE 0xff
+typedef struct {
+  uint8_t letter[26];
+  uint8_t star;
+  uint8_t checksum;
+} cmd_params_t;
+static char *cmd_line;           // the command being executed
+static cmd_params_t cmd_params;  // and its parameters
+
+#ifdef BINARY_PROTOCOL
+// Binary move frames, accepted after M217 S1 wherever a line could start, so ASCII lines
+// still work in between.  A frame is the sync byte, the payload length, the payload and a
+// CRC-16 (XMODEM, low byte first) over length and payload.  The payload is the G number
+// (0 or 1), a mask of the words present (bits 0-4: X Y Z E F), the line number as 16 bits,
+// then X Y Z E as 32-bit ten-thousandths of a mm and F as 16-bit mm/min, all low byte
+// first.  A frame takes the place of a line: it must carry the next line number, is
+// answered with "ok" or a resend request, and is queued as it arrived.
+// With PREPLANNED_BLOCKS and M217 S2, a payload starting with BIN_OP_BLOCK instead of a G
+// number carries a block planned by the host: the extruder, the line number, X Y Z E steps
+// as signed 32 bits, then accelerate_until, decelerate_after, initial, nominal and final
+// rate and acceleration_st as unsigned 32 bits (see preplanned_block_t).  It is answered
+// "ok" when it arrives, so a block that fails the checks when it is executed stops the
+// printer, and M999 asks for its line again.
+#define BIN_FRAME_SYNC     0xB5
+#define BIN_FRAME_TIMEOUT  100     // ms between the bytes of a frame
+#define BIN_COORD_SCALE    10000.0
+#define BIN_MOVE_HEADER    4       // G number, mask, line number
+#define BIN_WORDS          6       // X Y Z E F, and G from the opcode
+#define BIN_OP_BLOCK       0x80
+#define BIN_BLOCK_LENGTH   (BIN_MOVE_HEADER + 4 * NUM_AXIS + 4 * 6)
+static const char bin_words[BIN_WORDS] = {'X', 'Y', 'Z', 'E', 'F', 'G'};
+static uint8_t binary_mode = 0;         // 1: moves, 2: moves and host-planned blocks
+static bool bin_frame = false;          // receiving a frame
+static unsigned long bin_frame_millis;  // when its last byte came
+static bool cmd_binary;                 // the command being executed is a frame
+static uint8_t cmd_bin_mask;            // its words, as bits of bin_words
+static float cmd_bin_value[BIN_WORDS];
+static uint8_t cmd_bin_word;            // the word found by code_seen()
+#endif
+
 const int sensitive_pins[] = SENSITIVE_PINS; // Sensitive pin list for M42
 
 //static float tt = 0;
@@ -338,37 +412,167 @@ extern "C"{
   }
 }
 
+// Split a G-code number into an integer and a count of decimals: blanks, sign, digits and
+// an optional fraction, with no exponent, so "X10E5" stops at the E.  Returns false if
+// the digits will not fit a float exactly.
+static bool parse_decimal(const char *p, long &value, uint8_t &decimals)
+{
+  while(*p == ' ' || *p == '\t') p++;
+  bool neg = (*p == '-');
+  if(neg || *p == '+') p++;
+  unsigned long m = 0;
+  bool point = false;
+  decimals = 0;
+  for(;; p++) {
+    uint8_t d = *p - '0';
+    if(d <= 9) {
+      if(m >= 1677721UL) // 2^24 / 10: the next digit might not be exact
+        return false;
+      m = m * 10 + d;
+      if(point) decimals++;
+    }
+    else if(*p == '.' && !point)
+      point = true;
+    else
+      break;
+  }
+  value = neg ? -(long)m : (long)m;
+  return decimals < 11;
+}
+
+static const float pow10_P[] PROGMEM = { 1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10 };
+
+// Both operands are exact, so the quotient is rounded just as strtod's result is
+// (except that "-0" gives 0)
+static float parse_float(const char *p)
+{
+  long value;
+  uint8_t decimals;
+  if(!parse_decimal(p, value, decimals))
+    return strtod(p, NULL);
+  float f = value;
+  return decimals ? f / pgm_read_float(&pow10_P[decimals]) : f;
+}
+
+static long parse_long(const char *p)
+{
+  while(*p == ' ' || *p == '\t') p++;
+  bool neg = (*p == '-');
+  if(neg || *p == '+') p++;
+  long l = 0;
+  for(uint8_t d; (d = *p - '0') <= 9; p++)
+    l = l * 10 + d;
+  return neg ? -l : l;
+}
+
+static void cmd_index(const char *line, cmd_params_t &params)
+{
+  uint8_t checksum = 0;
+  memset(&params, CMD_PARAM_NONE, sizeof(params));
+  for(uint8_t i = 0; line[i]; i++) {
+    uint8_t l = line[i] - 'A';
+    if(l < 26) {
+      if(params.letter[l] == CMD_PARAM_NONE)
+        params.letter[l] = i;
+    }
+    else if(line[i] == '*' && params.star == CMD_PARAM_NONE) {
+      params.star = i;
+      params.checksum = checksum;
+    }
+    checksum ^= line[i];
+  }
+}
+
+// Make sure n bytes are free in one piece at bufindw, moving the partly received line
+// (serial_count characters behind the header) to the start of the ring if need be.
+static bool cmd_queue_room(int n)
+{
+  if(buflen == 0)
+    bufindr = bufindw;
+  else if(bufindw <= bufindr)
+    return bufindw < bufindr && bufindw + n <= bufindr;
+  if(bufindw + n <= CMD_QUEUE_SIZE)
+    return true;
+  if(buflen != 0 && n > bufindr)
+    return false;
+  if(bufindw < CMD_QUEUE_SIZE)
+    cmdbuffer[bufindw] = 0;
+  memmove(&cmdbuffer[1], &cmdbuffer[bufindw + 1], serial_count);
+  bufindw = 0;
+  if(buflen == 0)
+    bufindr = 0;
+  return true;
+}
+
+// Queue the received line or frame of serial_count bytes
+static void cmd_queue_push(uint8_t flags)
+{
+  cmdbuffer[bufindw + 1 + serial_count] = 0;
+  cmdbuffer[bufindw] = serial_count | flags;
+  bufindw += serial_count + 2;
+  #ifdef POWER_LOSS_RESUME
+    cmd_sdpos[(cmd_sdpos_r + buflen) % BUFSIZE] = cmd_queue_sdpos;
+  #endif
+  buflen += 1;
+}
+
+// Queue the received line of serial_count characters
+static void cmd_queue_commit(uint8_t flags)
+{
+  while(serial_count > 1 && cmdbuffer[bufindw + serial_count] == ' ')
+    serial_count--; // drop the blanks that stood before a comment
+  #ifdef BINARY_PROTOCOL
+    if((uint8_t)cmdbuffer[bufindw + 1] == BIN_FRAME_SYNC)
+      cmdbuffer[bufindw + 1] = ' '; // only a checked frame may start with it
+  #endif
+  cmd_queue_push(flags);
+}
+
+// Drop the command that has just been executed
+static void cmd_queue_advance()
+{
+  bufindr += ((uint8_t)cmdbuffer[bufindr] & CMD_LENGTH) + 2;
+  buflen -= 1;
+  #ifdef POWER_LOSS_RESUME
+    cmd_sdpos_r = (cmd_sdpos_r + 1) % BUFSIZE;
+  #endif
+  if(buflen && (bufindr >= CMD_QUEUE_SIZE || cmdbuffer[bufindr] == 0))
+    bufindr = 0;
+}
+
 //adds an command to the main command buffer
-//thats really done in a non-safe way.
-//needs overworking someday
+//a partly received line is moved up behind it
+static void enquecommand_len(const char *cmd, int len, bool progmem)
+{
+  if(buflen >= BUFSIZE || len == 0 || len >= MAX_CMD_SIZE || !cmd_queue_room(len + serial_count + 3))
+    return;
+  char *line = &cmdbuffer[bufindw + 1];
+  memmove(line + len + 2, line, serial_count);
+  if(progmem)
+    memcpy_P(line, cmd, len);
+  else
+    memcpy(line, cmd, len);
+  line[len] = 0;
+  cmdbuffer[bufindw] = len | CMD_QUIET;
+  bufindw += len + 2;
+  #ifdef POWER_LOSS_RESUME
+    cmd_sdpos[(cmd_sdpos_r + buflen) % BUFSIZE] = 0;
+  #endif
+  buflen += 1;
+  SERIAL_ECHO_START;
+  SERIAL_ECHOPGM("enqueing \"");
+  SERIAL_ECHO(line);
+  SERIAL_ECHOLNPGM("\"");
+}
+
 void enquecommand(const char *cmd)
 {
-  if(buflen < BUFSIZE)
-  {
-    //this is dangerous if a mixing of serial and this happsens
-    strcpy(&(cmdbuffer[bufindw][0]),cmd);
-    SERIAL_ECHO_START;
-    SERIAL_ECHOPGM("enqueing \"");
-    SERIAL_ECHO(cmdbuffer[bufindw]);
-    SERIAL_ECHOLNPGM("\"");
-    bufindw= (bufindw + 1)%BUFSIZE;
-    buflen += 1;
-  }
+  enquecommand_len(cmd, strlen(cmd), false);
 }
 
 void enquecommand_P(const char *cmd)
 {
-  if(buflen < BUFSIZE)
-  {
-    //this is dangerous if a mixing of serial and this happsens
-    strcpy_P(&(cmdbuffer[bufindw][0]),cmd);
-    SERIAL_ECHO_START;
-    SERIAL_ECHOPGM("enqueing \"");
-    SERIAL_ECHO(cmdbuffer[bufindw]);
-    SERIAL_ECHOLNPGM("\"");
-    bufindw= (bufindw + 1)%BUFSIZE;
-    buflen += 1;
-  }
+  enquecommand_len(cmd, strlen_P(cmd), true);
 }
 
 void setup_killpin()
@@ -488,10 +692,6 @@ void setup()
   SERIAL_ECHO(freeMemory());
   SERIAL_ECHOPGM(MSG_PLANNER_BUFFER_BYTES);
   SERIAL_ECHOLN((int)sizeof(block_t)*BLOCK_BUFFER_SIZE);
-  for(int8_t i = 0; i < BUFSIZE; i++)
-  {
-    fromsd[i] = false;
-  }
 
   // loads data from EEPROM if available else uses defaults (and resets step acceleration rate)
   Config_RetrieveSettings();
@@ -527,16 +727,16 @@ void loop()
     #ifdef SDSUPPORT
       if(card.saving)
       {
-        if(strstr_P(cmdbuffer[bufindr], PSTR("M29")) == NULL)
+        if(strstr_P(&cmdbuffer[bufindr + 1], PSTR("M29")) == NULL)
         {
-          card.write_command(cmdbuffer[bufindr]);
+          card.write_command(&cmdbuffer[bufindr + 1]);
           if(card.logging)
           {
             process_commands();
           }
           else
           {
-            SERIAL_PROTOCOLLNPGM(MSG_OK);
+            SendOk(buflen);
           }
         }
         else
@@ -552,8 +752,7 @@ void loop()
     #else
       process_commands();
     #endif //SDSUPPORT
-    buflen = (buflen-1);
-    bufindr = (bufindr + 1)%BUFSIZE;
+    cmd_queue_advance();
   }
   //check heater every n milliseconds
   manage_heater();
@@ -562,10 +761,170 @@ void loop()
   lcd_update();
 }
 
+#ifdef BINARY_PROTOCOL
+static void bin_frame_error(const char *msg)
+{
+  bin_frame = false;
+  serial_count = 0;
+  SERIAL_ERROR_START;
+  serialprintPGM(msg);
+  SERIAL_ERRORLN(gcode_LastN);
+  FlushSerialRequestResend();
+}
+
+// Take a byte of a binary move frame, which is built up in the command queue like a line
+static void bin_frame_byte(uint8_t c)
+{
+  uint8_t *frame = (uint8_t *)&cmdbuffer[bufindw + 1];
+  frame[serial_count++] = c;
+  bin_frame_millis = millis();
+  if(serial_count < 2)
+    return;
+  uint8_t len = frame[1];
+  if(len < BIN_MOVE_HEADER || len + 4 >= MAX_CMD_SIZE) {
+    bin_frame_error(PSTR(MSG_ERR_CHECKSUM_MISMATCH));
+    return;
+  }
+  if(serial_count < len + 4)
+    return;
+  bin_frame = false;
+
+  uint16_t crc = 0;
+  for(uint8_t i = 1; i < len + 2; i++)
+    crc = _crc_xmodem_update(crc, frame[i]);
+  const uint8_t *move = frame + 2;
+  uint8_t length = 0; // what the opcode calls for
+  if(move[0] <= 1 && !(move[1] & 0xe0)) {
+    length = BIN_MOVE_HEADER;
+    for(uint8_t i = 0; i < NUM_AXIS; i++)
+      if(move[1] & (1 << i)) length += 4;
+    if(move[1] & (1 << 4)) length += 2;
+  }
+  #ifdef PREPLANNED_BLOCKS
+  else if(move[0] == BIN_OP_BLOCK && binary_mode == 2 && move[1] < EXTRUDERS)
+    length = BIN_BLOCK_LENGTH;
+  #endif
+  if(crc != (frame[len + 2] | (frame[len + 3] << 8)) || len != length) {
+    bin_frame_error(PSTR(MSG_ERR_CHECKSUM_MISMATCH));
+    return;
+  }
+  if((move[2] | (move[3] << 8)) != (uint16_t)(gcode_LastN + 1)) {
+    bin_frame_error(PSTR(MSG_ERR_LINE_NO));
+    return;
+  }
+  gcode_LastN += 1;
+
+  #ifdef SDSUPPORT
+    if(card.saving) {
+      SERIAL_ERROR_START;
+      SERIAL_ERRORLNPGM(MSG_BINARY_NOT_TO_SD);
+      serial_count = 0;
+      SendOk(buflen);
+      return;
+    }
+  #endif
+  if(Stopped == false)
+    SendOk(buflen + 1); // this frame is not counted in buflen yet
+  else {
+    SERIAL_ERRORLNPGM(MSG_ERR_STOPPED);
+    LCD_MESSAGEPGM(MSG_STOPPED);
+  }
+  cmd_queue_push(0);
+  serial_count = 0;
+}
+
+static long bin_long(const uint8_t *p)
+{
+  return (long)p[0] | ((long)p[1] << 8) | ((long)p[2] << 16) | ((long)p[3] << 24);
+}
+
+// Unpack the frame being executed for code_seen() and code_value()
+static void cmd_bin_decode(const uint8_t *frame)
+{
+  const uint8_t *p = frame + 2 + BIN_MOVE_HEADER;
+  cmd_bin_mask = frame[3] | (1 << 5);
+  cmd_bin_value[5] = frame[2];
+  for(uint8_t i = 0; i < NUM_AXIS; i++) {
+    if(cmd_bin_mask & (1 << i)) {
+      cmd_bin_value[i] = (float)bin_long(p) / BIN_COORD_SCALE;
+      p += 4;
+    }
+  }
+  if(cmd_bin_mask & (1 << 4))
+    cmd_bin_value[4] = p[0] | (p[1] << 8);
+}
+
+#ifdef PREPLANNED_BLOCKS
+// Queue the host-planned block being executed, unless it leaves the software endstops
+static void cmd_bin_block(const uint8_t *frame)
+{
+  const uint8_t *p = frame + 2 + BIN_MOVE_HEADER;
+  preplanned_block_t pb;
+  for(uint8_t i = 0; i < NUM_AXIS; i++, p += 4)
+    pb.steps[i] = bin_long(p);
+  pb.accelerate_until = bin_long(p);
+  pb.decelerate_after = bin_long(p + 4);
+  pb.initial_rate = bin_long(p + 8);
+  pb.nominal_rate = bin_long(p + 12);
+  pb.final_rate = bin_long(p + 16);
+  pb.acceleration_st = bin_long(p + 20);
+
+  float delta[NUM_AXIS], target[NUM_AXIS], clamped[3];
+  for(uint8_t i = 0; i < NUM_AXIS; i++)
+    delta[i] = pb.steps[i] / axis_steps_per_unit[i];
+  #ifdef ENABLE_AUTO_BED_LEVELING
+  {
+    // The steps are in machine coordinates; current_position is not
+    vector_3 move = vector_3(delta[X_AXIS], delta[Y_AXIS], delta[Z_AXIS]);
+    move.apply_rotation(matrix_3x3::transpose(plan_bed_level_matrix));
+    delta[X_AXIS] = move.x;
+    delta[Y_AXIS] = move.y;
+    delta[Z_AXIS] = move.z;
+  }
+  #endif
+  for(uint8_t i = 0; i < NUM_AXIS; i++)
+    target[i] = current_position[i] + delta[i];
+  memcpy(clamped, target, sizeof(clamped));
+  clamp_to_software_endstops(clamped);
+  if(memcmp(clamped, target, sizeof(clamped)) != 0) {
+    SERIAL_ERROR_START;
+    SERIAL_ERRORPGM(MSG_BLOCK_REFUSED);
+    SERIAL_ERRORLNPGM(MSG_BLOCK_OUTSIDE_ENDSTOPS);
+  }
+  else if(plan_buffer_block(pb, frame[3])) {
+    memcpy(current_position, target, sizeof(target));
+    memcpy(destination, target, sizeof(target));
+    return;
+  }
+  // The block was acknowledged when it came in and the host has planned the ones
+  // after it from where it ends, so they would all run off by its steps.  Stop, and
+  // have M999 ask for this line again.
+  uint16_t low = frame[4] | (frame[5] << 8);  // of the line number
+  long line = gcode_LastN - (uint16_t)((uint16_t)gcode_LastN - low);
+  SERIAL_ERROR_START;
+  SERIAL_ERRORPGM(MSG_BLOCK_REFUSED_LINE);
+  SERIAL_ERRORLN(line);
+  Stop();
+  Stopped_gcode_LastN = line - 1;
+}
+#endif
+#endif //BINARY_PROTOCOL
+
 void get_command()
 {
-  while( MYSERIAL.available() > 0  && buflen < BUFSIZE) {
+  #ifdef BINARY_PROTOCOL
+  if(bin_frame && millis() - bin_frame_millis > BIN_FRAME_TIMEOUT)
+    bin_frame_error(PSTR(MSG_ERR_CHECKSUM_MISMATCH)); // the rest of the frame was lost
+  #endif
+  while( MYSERIAL.available() > 0  && buflen < BUFSIZE && cmd_queue_room(serial_count + 3)) {
     serial_char = MYSERIAL.read();
+    #ifdef BINARY_PROTOCOL
+    if(bin_frame || (binary_mode && serial_count == 0 && (uint8_t)serial_char == BIN_FRAME_SYNC)) {
+      bin_frame = true;
+      bin_frame_byte(serial_char);
+      continue;
+    }
+    #endif
     if(serial_char == '\n' ||
        serial_char == '\r' ||
        (serial_char == ':' && comment_mode == false) ||
@@ -575,15 +934,17 @@ void get_command()
         comment_mode = false; //for new command
         return;
       }
-      cmdbuffer[bufindw][serial_count] = 0; //terminate string
+      char *line = &cmdbuffer[bufindw + 1];
+      line[serial_count] = 0; //terminate string
       if(!comment_mode){
         comment_mode = false; //for new command
-        fromsd[bufindw] = false;
-        if(strchr(cmdbuffer[bufindw], 'N') != NULL)
+        cmd_params_t params;
+        cmd_index(line, params);
+        if(params.letter['N' - 'A'] != CMD_PARAM_NONE)
         {
-          strchr_pointer = strchr(cmdbuffer[bufindw], 'N');
-          gcode_N = (strtol(&cmdbuffer[bufindw][strchr_pointer - cmdbuffer[bufindw] + 1], NULL, 10));
-          if(gcode_N != gcode_LastN+1 && (strstr_P(cmdbuffer[bufindw], PSTR("M110")) == NULL) ) {
+          strchr_pointer = line + params.letter['N' - 'A'];
+          gcode_N = (parse_long(strchr_pointer + 1));
+          if(gcode_N != gcode_LastN+1 && (strstr_P(line, PSTR("M110")) == NULL) ) {
             SERIAL_ERROR_START;
             SERIAL_ERRORPGM(MSG_ERR_LINE_NO);
             SERIAL_ERRORLN(gcode_LastN);
@@ -593,14 +954,11 @@ void get_command()
             return;
           }
 
-          if(strchr(cmdbuffer[bufindw], '*') != NULL)
+          if(params.star != CMD_PARAM_NONE)
           {
-            byte checksum = 0;
-            byte count = 0;
-            while(cmdbuffer[bufindw][count] != '*') checksum = checksum^cmdbuffer[bufindw][count++];
-            strchr_pointer = strchr(cmdbuffer[bufindw], '*');
+            strchr_pointer = line + params.star;
 
-            if( (int)(strtod(&cmdbuffer[bufindw][strchr_pointer - cmdbuffer[bufindw] + 1], NULL)) != checksum) {
+            if( (int)(parse_long(strchr_pointer + 1)) != params.checksum) {
               SERIAL_ERROR_START;
               SERIAL_ERRORPGM(MSG_ERR_CHECKSUM_MISMATCH);
               SERIAL_ERRORLN(gcode_LastN);
@@ -625,7 +983,7 @@ void get_command()
         }
         else  // if we don't receive 'N' but still see '*'
         {
-          if((strchr(cmdbuffer[bufindw], '*') != NULL))
+          if(params.star != CMD_PARAM_NONE)
           {
             SERIAL_ERROR_START;
             SERIAL_ERRORPGM(MSG_ERR_NO_LINENUMBER_WITH_CHECKSUM);
@@ -634,9 +992,9 @@ void get_command()
             return;
           }
         }
-        if((strchr(cmdbuffer[bufindw], 'G') != NULL)){
-          strchr_pointer = strchr(cmdbuffer[bufindw], 'G');
-          switch((int)((strtod(&cmdbuffer[bufindw][strchr_pointer - cmdbuffer[bufindw] + 1], NULL)))){
+        if(params.letter['G' - 'A'] != CMD_PARAM_NONE){
+          strchr_pointer = line + params.letter['G' - 'A'];
+          switch((int)(parse_long(strchr_pointer + 1))){
           case 0:
           case 1:
           case 2:
@@ -646,7 +1004,7 @@ void get_command()
               if(card.saving)
                 break;
           #endif //SDSUPPORT
-              SERIAL_PROTOCOLLNPGM(MSG_OK);
+              SendOk(buflen + 1); // this line is not counted in buflen yet
             }
             else {
               SERIAL_ERRORLNPGM(MSG_ERR_STOPPED);
@@ -658,15 +1016,14 @@ void get_command()
           }
 
         }
-        bufindw = (bufindw + 1)%BUFSIZE;
-        buflen += 1;
+        cmd_queue_commit(0);
       }
       serial_count = 0; //clear buffer
     }
     else
     {
       if(serial_char == ';') comment_mode = true;
-      if(!comment_mode) cmdbuffer[bufindw][serial_count++] = serial_char;
+      if(!comment_mode) cmdbuffer[bufindw + 1 + serial_count++] = serial_char;
     }
   }
   #ifdef SDSUPPORT
@@ -681,7 +1038,7 @@ void get_command()
   static bool stop_buffering=false;
   if(buflen==0) stop_buffering=false;
 
-  while( !card.eof()  && buflen < BUFSIZE && !stop_buffering) {
+  while( !card.eof()  && buflen < BUFSIZE && !stop_buffering && cmd_queue_room(serial_count + 3)) {
     int16_t n=card.get();
     serial_char = (char)n;
     if(serial_char == '\n' ||
@@ -714,11 +1071,14 @@ void get_command()
         comment_mode = false; //for new command
         return; //if empty line
       }
-      cmdbuffer[bufindw][serial_count] = 0; //terminate string
 //      if(!comment_mode){
-        fromsd[bufindw] = true;
-        buflen += 1;
-        bufindw = (bufindw + 1)%BUFSIZE;
+        #ifdef POWER_LOSS_RESUME
+          cmd_queue_sdpos = card.getIndex() + 1; // the next line starts behind this character
+        #endif
+        cmd_queue_commit(CMD_QUIET);
+        #ifdef POWER_LOSS_RESUME
+          cmd_queue_sdpos = 0;
+        #endif
 //      }
       comment_mode = false; //for new command
       serial_count = 0; //clear buffer
@@ -726,7 +1086,7 @@ void get_command()
     else
     {
       if(serial_char == ';') comment_mode = true;
-      if(!comment_mode) cmdbuffer[bufindw][serial_count++] = serial_char;
+      if(!comment_mode) cmdbuffer[bufindw + 1 + serial_count++] = serial_char;
     }
   }
 
@@ -737,17 +1097,35 @@ void get_command()
 
 float code_value()
 {
-  return (strtod(&cmdbuffer[bufindr][strchr_pointer - cmdbuffer[bufindr] + 1], NULL));
+  #ifdef BINARY_PROTOCOL
+    if(cmd_binary) return cmd_bin_value[cmd_bin_word];
+  #endif
+  return (parse_float(strchr_pointer + 1));
 }
 
 long code_value_long()
 {
-  return (strtol(&cmdbuffer[bufindr][strchr_pointer - cmdbuffer[bufindr] + 1], NULL, 10));
+  #ifdef BINARY_PROTOCOL
+    if(cmd_binary) return cmd_bin_value[cmd_bin_word];
+  #endif
+  return (parse_long(strchr_pointer + 1));
 }
 
 bool code_seen(char code)
 {
-  strchr_pointer = strchr(cmdbuffer[bufindr], code);
+  #ifdef BINARY_PROTOCOL
+    if(cmd_binary) {
+      for(cmd_bin_word = 0; cmd_bin_word < BIN_WORDS; cmd_bin_word++)
+        if(bin_words[cmd_bin_word] == code)
+          return cmd_bin_mask & (1 << cmd_bin_word);
+      return false;
+    }
+  #endif
+  uint8_t l = code - 'A';
+  if(l < 26)
+    strchr_pointer = cmd_params.letter[l] == CMD_PARAM_NONE ? NULL : cmd_line + cmd_params.letter[l];
+  else
+    strchr_pointer = strchr(cmd_line, code);
   return (strchr_pointer != NULL);  //Return True if a character was found
 }
 
@@ -1091,6 +1469,329 @@ void JumpToBootloader(void)
 	while (1) ;
 }
 
+// The temperatures and heater power of M105, without "ok" or the end of line
+static void report_temperatures(int8_t extruder)
+{
+  #if defined(TEMP_0_PIN) && TEMP_0_PIN > -1
+    SERIAL_PROTOCOLPGM("T:");
+    SERIAL_PROTOCOL_F(degHotend(extruder),1);
+    SERIAL_PROTOCOLPGM(" /");
+    SERIAL_PROTOCOL_F(degTargetHotend(extruder),1);
+    #if defined(TEMP_BED_PIN) && TEMP_BED_PIN > -1
+      SERIAL_PROTOCOLPGM(" B:");
+      SERIAL_PROTOCOL_F(degBed(),1);
+      SERIAL_PROTOCOLPGM(" /");
+      SERIAL_PROTOCOL_F(degTargetBed(),1);
+    #endif //TEMP_BED_PIN
+    for (int8_t cur_extruder = 0; cur_extruder < EXTRUDERS; ++cur_extruder) {
+      SERIAL_PROTOCOLPGM(" T");
+      SERIAL_PROTOCOL(cur_extruder);
+      SERIAL_PROTOCOLPGM(":");
+      SERIAL_PROTOCOL_F(degHotend(cur_extruder),1);
+      SERIAL_PROTOCOLPGM(" /");
+      SERIAL_PROTOCOL_F(degTargetHotend(cur_extruder),1);
+    }
+  #else
+    SERIAL_ERROR_START;
+    SERIAL_ERRORLNPGM(MSG_ERR_NO_THERMISTORS);
+  #endif
+
+    SERIAL_PROTOCOLPGM(" @:");
+    SERIAL_PROTOCOL(getHeaterPower(extruder));
+
+    SERIAL_PROTOCOLPGM(" B@:");
+    SERIAL_PROTOCOL(getHeaterPower(-1));
+
+    #ifdef SHOW_TEMP_ADC_VALUES
+      #if defined(TEMP_BED_PIN) && TEMP_BED_PIN > -1
+        SERIAL_PROTOCOLPGM("    ADC B:");
+        SERIAL_PROTOCOL_F(degBed(),1);
+        SERIAL_PROTOCOLPGM("C->");
+        SERIAL_PROTOCOL_F(rawBedTemp()/OVERSAMPLENR,0);
+      #endif
+      for (int8_t cur_extruder = 0; cur_extruder < EXTRUDERS; ++cur_extruder) {
+        SERIAL_PROTOCOLPGM("  T");
+        SERIAL_PROTOCOL(cur_extruder);
+        SERIAL_PROTOCOLPGM(":");
+        SERIAL_PROTOCOL_F(degHotend(cur_extruder),1);
+        SERIAL_PROTOCOLPGM("C->");
+        SERIAL_PROTOCOL_F(rawHotendTemp(cur_extruder)/OVERSAMPLENR,0);
+      }
+    #endif
+}
+
+// The line M114 prints
+static void report_position()
+{
+  SERIAL_PROTOCOLPGM("X:");
+  SERIAL_PROTOCOL(current_position[X_AXIS]);
+  SERIAL_PROTOCOLPGM("Y:");
+  SERIAL_PROTOCOL(current_position[Y_AXIS]);
+  SERIAL_PROTOCOLPGM("Z:");
+  SERIAL_PROTOCOL(current_position[Z_AXIS]);
+  SERIAL_PROTOCOLPGM("E:");
+  SERIAL_PROTOCOL(current_position[E_AXIS]);
+
+  SERIAL_PROTOCOLPGM(MSG_COUNT_X);
+  SERIAL_PROTOCOL(float(st_get_position(X_AXIS))/axis_steps_per_unit[X_AXIS]);
+  SERIAL_PROTOCOLPGM("Y:");
+  SERIAL_PROTOCOL(float(st_get_position(Y_AXIS))/axis_steps_per_unit[Y_AXIS]);
+  SERIAL_PROTOCOLPGM("Z:");
+  SERIAL_PROTOCOL(float(st_get_position(Z_AXIS))/axis_steps_per_unit[Z_AXIS]);
+
+  SERIAL_PROTOCOLLN("");
+}
+
+#ifdef AUTO_REPORT
+static unsigned long auto_report_interval = 0; // ms, 0 = off
+static unsigned long auto_report_millis;
+
+// The unsolicited report M155 turns on, so the host need not poll with M105/M114/M27
+static void auto_report()
+{
+  if(!auto_report_interval || millis() - auto_report_millis < auto_report_interval)
+    return;
+  auto_report_millis = millis();
+  report_temperatures(active_extruder);
+  SERIAL_PROTOCOLLN("");
+  report_position();
+  SERIAL_ECHO_START;
+  SERIAL_ECHOPGM("Planned:");
+  SERIAL_ECHO((int)movesplanned());
+  SERIAL_ECHOPGM("/");
+  SERIAL_ECHO(BLOCK_BUFFER_SIZE - 1);
+  SERIAL_ECHOPGM(" Queued:");
+  SERIAL_ECHOLN((int)buflen);
+  #ifdef SDSUPPORT
+  if(card.sdprinting)
+    card.getStatus();
+  #endif
+}
+#endif
+
+#ifdef POWER_LOSS_RESUME
+static unsigned long plr_millis = 0;
+
+// Take the modal state into plan_resume, for the moves of the command being executed
+static void plr_snapshot()
+{
+  plan_resume.feedrate = feedrate;
+  for(int8_t e = 0; e < EXTRUDERS; e++)
+    plan_resume.target_temperature[e] = target_temperature[e];
+  plan_resume.target_temperature_bed = target_temperature_bed;
+  plan_resume.fan_speed = fanSpeed;
+  plan_resume.extruder = active_extruder;
+  plan_resume.flags = (relative_mode ? PLR_RELATIVE_XYZ : 0) | (axis_relative_modes[E_AXIS] ? PLR_RELATIVE_E : 0);
+}
+
+// Journal how far the SD print has got, every PLR_INTERVAL while it runs.  The state
+// goes in as it was when the moves were planned, not as the parser has it now.
+static void plr_checkpoint()
+{
+  plr_idle();
+  if(!card.sdprinting || plr_busy() || millis() - plr_millis < PLR_INTERVAL)
+    return;
+  plr_record_t rec;
+  if(!st_checkpoint(rec.resume, rec.steps) || !rec.resume.sdpos)
+    return; // nothing finished since the last record
+  plr_millis = millis();
+  #ifdef ENABLE_AUTO_BED_LEVELING
+    memcpy(rec.bed_level, plan_bed_level_matrix.matrix, sizeof(rec.bed_level));
+  #endif
+  plr_write(rec);
+}
+
+// M1000 takes the position the journal has for the axes, lifts Z, homes X and Y to get
+// the nozzle off the print, and queues the heating, then M1000 C; that goes back to the
+// print and carries on with the file.  The steps are machine positions, so the leveling
+// stays off until then.
+static void plr_resume(bool carry_on)
+{
+  plr_record_t rec;
+  char name[MAXPATHNAMELENGTH];
+  if(card.sdprinting) {
+    SERIAL_ERROR_START;
+    SERIAL_ERRORLNPGM(MSG_NOT_WHILE_SD_PRINTING);
+    return;
+  }
+  if(!card.cardOK || !plr_load(rec, name)) {
+    SERIAL_ERROR_START;
+    SERIAL_ERRORLNPGM(MSG_PLR_NOTHING);
+    return;
+  }
+  st_synchronize();
+  if(!carry_on) {
+    #ifdef ENABLE_AUTO_BED_LEVELING
+      plan_bed_level_matrix.set_to_identity();
+    #endif
+    for(int8_t i = 0; i < NUM_AXIS; i++)
+      current_position[i] = destination[i] = rec.steps[i] / axis_steps_per_unit[i];
+    plan_set_position(current_position[X_AXIS], current_position[Y_AXIS], current_position[Z_AXIS], current_position[E_AXIS]);
+    current_position[Z_AXIS] += PLR_Z_LIFT;
+    plan_buffer_line(current_position[X_AXIS], current_position[Y_AXIS], current_position[Z_AXIS], current_position[E_AXIS], homing_feedrate[Z_AXIS]/60, active_extruder);
+
+    char cmd[20];
+    #if EXTRUDERS > 1
+      sprintf_P(cmd, PSTR("T%d"), rec.resume.extruder);
+      enquecommand(cmd);
+    #endif
+    enquecommand_P(PSTR("G28 X Y")); // park before the nozzle gets hot
+    for(int8_t e = 0; e < EXTRUDERS; e++) {
+      sprintf_P(cmd, PSTR("M104 T%d S%d"), e, rec.resume.target_temperature[e]);
+      enquecommand(cmd);
+    }
+    if(rec.resume.target_temperature_bed) {
+      sprintf_P(cmd, PSTR("M190 S%d"), rec.resume.target_temperature_bed);
+      enquecommand(cmd);
+    }
+    for(int8_t e = 0; e < EXTRUDERS; e++) {
+      if(rec.resume.target_temperature[e]) {
+        sprintf_P(cmd, PSTR("M109 T%d S%d"), e, rec.resume.target_temperature[e]);
+        enquecommand(cmd);
+      }
+    }
+    enquecommand_P(PSTR("M1000 C"));
+    return;
+  }
+
+  float target[3];
+  for(int8_t i = 0; i < 3; i++)
+    target[i] = rec.steps[i] / axis_steps_per_unit[i];
+  #ifdef ENABLE_AUTO_BED_LEVELING
+    // Level again, and go on in the coordinates the leveling makes of the machine's
+    memcpy(plan_bed_level_matrix.matrix, rec.bed_level, sizeof(rec.bed_level));
+    vector_3 position = plan_get_position();
+    current_position[X_AXIS] = position.x;
+    current_position[Y_AXIS] = position.y;
+    current_position[Z_AXIS] = position.z;
+    plan_set_position(current_position[X_AXIS], current_position[Y_AXIS], current_position[Z_AXIS], current_position[E_AXIS]);
+    apply_rotation_xyz(matrix_3x3::transpose(plan_bed_level_matrix), target[X_AXIS], target[Y_AXIS], target[Z_AXIS]);
+  #endif
+  current_position[X_AXIS] = target[X_AXIS];
+  current_position[Y_AXIS] = target[Y_AXIS];
+  plan_buffer_line(current_position[X_AXIS], current_position[Y_AXIS], current_position[Z_AXIS], current_position[E_AXIS], homing_feedrate[X_AXIS]/60, active_extruder);
+  current_position[Z_AXIS] = target[Z_AXIS];
+  plan_buffer_line(current_position[X_AXIS], current_position[Y_AXIS], current_position[Z_AXIS], current_position[E_AXIS], homing_feedrate[Z_AXIS]/60, active_extruder);
+  for(int8_t i = 0; i < NUM_AXIS; i++)
+    destination[i] = current_position[i];
+
+  feedrate = rec.resume.feedrate;
+  fanSpeed = rec.resume.fan_speed;
+  relative_mode = (rec.resume.flags & PLR_RELATIVE_XYZ) != 0;
+  axis_relative_modes[E_AXIS] = (rec.resume.flags & PLR_RELATIVE_E) != 0;
+  card.openFile(name, true);
+  if(!card.isFileOpen())
+    return;
+  card.setIndex(rec.resume.sdpos);
+  card.startFileprint();
+  starttime = millis();
+}
+#endif
+
+#ifdef BINARY_TELEMETRY
+// Telemetry frames are framed like the binary move frames: TELEMETRY_SYNC, the payload
+// length, the payload and a CRC-16 (XMODEM, low byte first) over length and payload.
+// Text output never contains a byte above 0x7f, so the host can pick them out of it.
+// The payload, all values low byte first:
+//   u8  TELEMETRY_OP
+//   u8  frame number, counting up; a gap means frames were dropped
+//   u32 millis()
+//   u8  frames dropped since the last one because the transmit buffer was full
+//   u8  moves in the planner
+//   u8  index of the block being stepped (block_buffer_tail)
+//   u8  commands queued
+//   u16 stepper ISR load in 1/100 % since the last frame, 0xffff without STEPPER_ISR_PROFILE
+//   s32 X Y Z E position in steps (count_position[])
+//   s16 bed temperature, raw oversampled ADC;  u8 bed heater PWM
+//   EXTRUDERS times:  s16 hotend temperature, raw;  u8 heater PWM
+//   u16 STATUS and u16 events counted by the health monitor, for the X Y Z E0 L6470s
+//       (all 0 without L6470_HEALTH_MONITOR)
+#define TELEMETRY_SYNC    0xB5
+#define TELEMETRY_OP      0x81
+#define TELEMETRY_LENGTH  (12 + 4 * NUM_AXIS + 3 * (1 + EXTRUDERS) + 4 * 4)
+static unsigned long telemetry_interval = 0;  // ms, 0 = off
+static unsigned long telemetry_millis;
+static uint8_t telemetry_count = 0;
+static uint8_t telemetry_dropped = 0;
+
+static uint8_t *telemetry_put(uint8_t *p, unsigned long v, uint8_t bytes)
+{
+  while(bytes--) {
+    *p++ = v;
+    v >>= 8;
+  }
+  return p;
+}
+
+static void telemetry()
+{
+  if(!telemetry_interval || millis() - telemetry_millis < telemetry_interval)
+    return;
+  telemetry_millis += telemetry_interval;
+  if(millis() - telemetry_millis >= telemetry_interval)
+    telemetry_millis = millis();  // fell behind, don't send a burst to catch up
+  #ifdef SERIAL_TX_BUFFER
+  // Waiting for room would hold up the main loop and starve the planner
+  if(MSerial.txRoom() < TELEMETRY_LENGTH + 4) {
+    if(telemetry_dropped < 0xff) telemetry_dropped++;
+    return;
+  }
+  #endif
+
+  // The raw readings are written by the temperature ISR; take them in one piece
+  int temp_raw[EXTRUDERS], temp_bed_raw;
+  CRITICAL_SECTION_START;
+  memcpy(temp_raw, current_temperature_raw, sizeof(temp_raw));
+  temp_bed_raw = current_temperature_bed_raw;
+  CRITICAL_SECTION_END;
+
+  uint8_t frame[TELEMETRY_LENGTH + 4];
+  uint8_t *p = frame + 2;
+  *p++ = TELEMETRY_OP;
+  *p++ = telemetry_count++;
+  p = telemetry_put(p, millis(), 4);
+  *p++ = telemetry_dropped;
+  *p++ = movesplanned();
+  *p++ = block_buffer_tail;
+  *p++ = buflen;
+  #ifdef STEPPER_ISR_PROFILE
+  p = telemetry_put(p, st_isr_load(), 2);
+  #else
+  p = telemetry_put(p, 0xffff, 2);
+  #endif
+  for(int8_t i = 0; i < NUM_AXIS; i++)
+    p = telemetry_put(p, st_get_position(i), 4);
+  p = telemetry_put(p, temp_bed_raw, 2);
+  *p++ = getHeaterPower(-1);
+  for(int8_t e = 0; e < EXTRUDERS; e++) {
+    p = telemetry_put(p, temp_raw[e], 2);
+    *p++ = getHeaterPower(e);
+  }
+  for(uint8_t i = 0; i < 4; i++) {
+    #ifdef L6470_HEALTH_MONITOR
+    uint16_t events = 0;
+    for(uint8_t ev = 0; ev < L6470_EVENTS; ev++)
+      events += l6470_health[i].count[ev];
+    p = telemetry_put(p, l6470_health[i].status, 2);
+    p = telemetry_put(p, events, 2);
+    #else
+    p = telemetry_put(p, 0, 4);
+    #endif
+  }
+  telemetry_dropped = 0;
+
+  frame[0] = TELEMETRY_SYNC;
+  frame[1] = TELEMETRY_LENGTH;
+  uint16_t crc = 0;
+  for(uint8_t *q = frame + 1; q < p; q++)
+    crc = _crc_xmodem_update(crc, *q);
+  *p++ = crc;
+  *p++ = crc >> 8;
+  for(uint8_t *q = frame; q < p; q++)
+    MYSERIAL.write(*q);
+}
+#endif
+
 void process_commands()
 {
   unsigned long codenum; //throw away variable
@@ -1098,6 +1799,25 @@ void process_commands()
 #ifdef ENABLE_AUTO_BED_LEVELING
   float x_tmp, y_tmp, z_tmp, real_z;
 #endif
+  cmd_line = &cmdbuffer[bufindr + 1];
+  #ifdef POWER_LOSS_RESUME
+    plan_resume.sdpos = cmd_sdpos[cmd_sdpos_r];
+    plr_snapshot();
+  #endif
+  #ifdef BINARY_PROTOCOL
+    cmd_binary = ((uint8_t)cmd_line[0] == BIN_FRAME_SYNC);
+    #ifdef PREPLANNED_BLOCKS
+    if(cmd_binary && (uint8_t)cmd_line[2] == BIN_OP_BLOCK) {
+      if(Stopped == false)
+        cmd_bin_block((uint8_t *)cmd_line);
+      return; // acknowledged when it was received
+    }
+    #endif
+    if(cmd_binary)
+      cmd_bin_decode((uint8_t *)cmd_line);
+    else
+  #endif
+  cmd_index(cmd_line, cmd_params);
   if(code_seen('G'))
   {
     switch((int)code_value())
@@ -1599,7 +2319,7 @@ void process_commands()
     case 28: //M28 - Start SD write
       starpos = (strchr(strchr_pointer + 4,'*'));
       if(starpos != NULL){
-        char* npos = strchr(cmdbuffer[bufindr], 'N');
+        char* npos = strchr(&cmdbuffer[bufindr + 1], 'N');
         strchr_pointer = strchr(npos,' ') + 1;
         *(starpos-1) = '\0';
       }
@@ -1614,7 +2334,7 @@ void process_commands()
         card.closefile();
         starpos = (strchr(strchr_pointer + 4,'*'));
         if(starpos != NULL){
-          char* npos = strchr(cmdbuffer[bufindr], 'N');
+          char* npos = strchr(&cmdbuffer[bufindr + 1], 'N');
           strchr_pointer = strchr(npos,' ') + 1;
           *(starpos-1) = '\0';
         }
@@ -1656,10 +2376,41 @@ void process_commands()
           starttime=millis(); //procedure calls count as normal print time.
       }
     } break;
+    #ifdef SD_BINARY_UPLOAD
+    case 35: //M35 - Binary upload to SD
+      starpos = (strchr(strchr_pointer + 4,'*'));
+      if(starpos != NULL){
+        char* npos = strchr(&cmdbuffer[bufindr + 1], 'N');
+        strchr_pointer = strchr(npos,' ') + 1;
+        *(starpos-1) = '\0';
+      }
+      if(card.sdprinting) {
+        SERIAL_ERROR_START;
+        SERIAL_ERRORLNPGM(MSG_NOT_WHILE_SD_PRINTING);
+        break;
+      }
+      card.openFile(strchr_pointer+4,false);
+      if(card.saving)
+        card.binaryUpload();
+      break;
+    #endif
+    #ifdef SD_READ_STREAM
+    case 36: //M36 S<blocks> - Compare single block and streamed read rates
+    {
+      long blocks = code_seen('S') ? code_value_long() : 1024;
+      if(blocks < 1 || blocks > 65535) {
+        SERIAL_ERROR_START;
+        SERIAL_ERRORLNPGM(MSG_SD_BENCH_BLOCKS);
+      }
+      else
+        card.readBenchmark(blocks);
+    }
+    break;
+    #endif
     case 928: //M928 - Start SD write
       starpos = (strchr(strchr_pointer + 5,'*'));
       if(starpos != NULL){
-        char* npos = strchr(cmdbuffer[bufindr], 'N');
+        char* npos = strchr(&cmdbuffer[bufindr + 1], 'N');
         strchr_pointer = strchr(npos,' ') + 1;
         *(starpos-1) = '\0';
       }
@@ -1728,53 +2479,8 @@ void process_commands()
       if(setTargetedHotend(105)){
         break;
         }
-      #if defined(TEMP_0_PIN) && TEMP_0_PIN > -1
-        SERIAL_PROTOCOLPGM("ok T:");
-        SERIAL_PROTOCOL_F(degHotend(tmp_extruder),1);
-        SERIAL_PROTOCOLPGM(" /");
-        SERIAL_PROTOCOL_F(degTargetHotend(tmp_extruder),1);
-        #if defined(TEMP_BED_PIN) && TEMP_BED_PIN > -1
-          SERIAL_PROTOCOLPGM(" B:");
-          SERIAL_PROTOCOL_F(degBed(),1);
-          SERIAL_PROTOCOLPGM(" /");
-          SERIAL_PROTOCOL_F(degTargetBed(),1);
-        #endif //TEMP_BED_PIN
-        for (int8_t cur_extruder = 0; cur_extruder < EXTRUDERS; ++cur_extruder) {
-          SERIAL_PROTOCOLPGM(" T");
-          SERIAL_PROTOCOL(cur_extruder);
-          SERIAL_PROTOCOLPGM(":");
-          SERIAL_PROTOCOL_F(degHotend(cur_extruder),1);
-          SERIAL_PROTOCOLPGM(" /");
-          SERIAL_PROTOCOL_F(degTargetHotend(cur_extruder),1);
-        }
-      #else
-        SERIAL_ERROR_START;
-        SERIAL_ERRORLNPGM(MSG_ERR_NO_THERMISTORS);
-      #endif
-
-        SERIAL_PROTOCOLPGM(" @:");
-        SERIAL_PROTOCOL(getHeaterPower(tmp_extruder));
-
-        SERIAL_PROTOCOLPGM(" B@:");
-        SERIAL_PROTOCOL(getHeaterPower(-1));
-
-        #ifdef SHOW_TEMP_ADC_VALUES
-          #if defined(TEMP_BED_PIN) && TEMP_BED_PIN > -1
-            SERIAL_PROTOCOLPGM("    ADC B:");
-            SERIAL_PROTOCOL_F(degBed(),1);
-            SERIAL_PROTOCOLPGM("C->");
-            SERIAL_PROTOCOL_F(rawBedTemp()/OVERSAMPLENR,0);
-          #endif
-          for (int8_t cur_extruder = 0; cur_extruder < EXTRUDERS; ++cur_extruder) {
-            SERIAL_PROTOCOLPGM("  T");
-            SERIAL_PROTOCOL(cur_extruder);
-            SERIAL_PROTOCOLPGM(":");
-            SERIAL_PROTOCOL_F(degHotend(cur_extruder),1);
-            SERIAL_PROTOCOLPGM("C->");
-            SERIAL_PROTOCOL_F(rawHotendTemp(cur_extruder)/OVERSAMPLENR,0);
-          }
-        #endif
-		
+        SERIAL_PROTOCOLPGM("ok ");
+        report_temperatures(tmp_extruder);
         SERIAL_PROTOCOLLN("");
       return;
       break;
@@ -2097,23 +2803,7 @@ void process_commands()
 
       break;
     case 114: // M114
-      SERIAL_PROTOCOLPGM("X:");
-      SERIAL_PROTOCOL(current_position[X_AXIS]);
-      SERIAL_PROTOCOLPGM("Y:");
-      SERIAL_PROTOCOL(current_position[Y_AXIS]);
-      SERIAL_PROTOCOLPGM("Z:");
-      SERIAL_PROTOCOL(current_position[Z_AXIS]);
-      SERIAL_PROTOCOLPGM("E:");
-      SERIAL_PROTOCOL(current_position[E_AXIS]);
-
-      SERIAL_PROTOCOLPGM(MSG_COUNT_X);
-      SERIAL_PROTOCOL(float(st_get_position(X_AXIS))/axis_steps_per_unit[X_AXIS]);
-      SERIAL_PROTOCOLPGM("Y:");
-      SERIAL_PROTOCOL(float(st_get_position(Y_AXIS))/axis_steps_per_unit[Y_AXIS]);
-      SERIAL_PROTOCOLPGM("Z:");
-      SERIAL_PROTOCOL(float(st_get_position(Z_AXIS))/axis_steps_per_unit[Z_AXIS]);
-
-      SERIAL_PROTOCOLLN("");
+      report_position();
       break;
     case 120: // M120
       enable_endstops(false) ;
@@ -2164,6 +2854,24 @@ void process_commands()
       }
       break;
     #endif //BLINKM
+    #ifdef AUTO_REPORT
+    case 155: // M155 S<seconds> auto report interval
+      if(code_seen('S')) {
+        float seconds = code_value();
+        auto_report_interval = seconds > 0 ? min(seconds, 60) * 1000 : 0;
+        auto_report_millis = millis();
+      }
+      break;
+    #endif
+    #ifdef BINARY_TELEMETRY
+    case 156: // M156 S<Hz> binary telemetry rate
+      if(code_seen('S')) {
+        float hz = code_value();
+        telemetry_interval = hz > 0 ? 1000 / constrain(hz, 1, TELEMETRY_MAX_HZ) : 0;
+        telemetry_millis = millis();
+      }
+      break;
+    #endif
     case 201: // M201
       for(int8_t i=0; i < NUM_AXIS; i++)
       {
@@ -2256,7 +2964,7 @@ void process_commands()
           default:
             SERIAL_ECHO_START;
             SERIAL_ECHOPGM(MSG_UNKNOWN_COMMAND);
-            SERIAL_ECHO(cmdbuffer[bufindr]);
+            SERIAL_ECHO(&cmdbuffer[bufindr + 1]);
             SERIAL_ECHOLNPGM("\"");
         }
       }
@@ -2358,6 +3066,57 @@ void process_commands()
 		}
 	}break;
 	#endif
+    #ifdef L6470_STEP_VERIFY
+    case 214: // M214 L6470 step verification
+    {
+      if(code_seen('S')) l6470_verify_enabled = (code_value() != 0);
+      if(code_seen('P')) l6470_verify_interval = code_value_long();
+      if(code_seen('T')) l6470_verify_tolerance = code_value_long();
+      if(code_seen('A')) l6470_verify_action = code_value();
+      if(code_seen('R')) st_l6470_verify_resync();
+      st_l6470_verify_report();
+    }
+    break;
+    #endif
+    #ifdef L6470_HEALTH_MONITOR
+    case 215: // M215 L6470 health report
+    {
+      if(code_seen('P')) l6470_health_interval = code_value_long();
+      if(code_seen('A')) l6470_health_action = code_value();
+      if(code_seen('R')) st_l6470_health_reset();
+      st_l6470_health_report();
+    }
+    break;
+    #endif
+    #ifdef STEPPER_ISR_PROFILE
+    case 216: // M216 Stepper ISR profile
+    {
+      if(code_seen('R')) st_isr_profile_reset();
+      else st_isr_profile_report();
+    }
+    break;
+    #endif
+    #ifdef BINARY_PROTOCOL
+    case 217: // M217 S<1=on/0=off/2=with blocks> binary move frames
+    {
+      if(code_seen('S')) {
+        long mode = code_value_long();
+        if(mode < 0 || mode > 2) {
+          SERIAL_ERROR_START;
+          SERIAL_ERRORLNPGM(MSG_BINARY_MODE_INVALID);
+        }
+        else
+          binary_mode = mode;
+      }
+      #ifndef PREPLANNED_BLOCKS
+      if(binary_mode > 1) binary_mode = 1;
+      #endif
+      SERIAL_ECHO_START;
+      SERIAL_ECHOPGM(MSG_BINARY_MODE);
+      SERIAL_ECHOLN((int)binary_mode);
+    }
+    break;
+    #endif
     case 220: // M220 S<factor in percent>- set speed factor override percentage
     {
       if(code_seen('S'))
@@ -2902,6 +3661,11 @@ void process_commands()
       gcode_LastN = Stopped_gcode_LastN;
       FlushSerialRequestResend();
     break;
+    #ifdef POWER_LOSS_RESUME
+    case 1000: // M1000 [C] resume the journaled SD print
+      plr_resume(code_seen('C'));
+      break;
+    #endif
     }
   }
 
@@ -3005,7 +3769,7 @@ void process_commands()
   {
     SERIAL_ECHO_START;
     SERIAL_ECHOPGM(MSG_UNKNOWN_COMMAND);
-    SERIAL_ECHO(cmdbuffer[bufindr]);
+    SERIAL_ECHO(&cmdbuffer[bufindr + 1]);
     SERIAL_ECHOLNPGM("\"");
   }
 
@@ -3018,17 +3782,34 @@ void FlushSerialRequestResend()
   MYSERIAL.flush();
   SERIAL_PROTOCOLPGM(MSG_RESEND);
   SERIAL_PROTOCOLLN(gcode_LastN + 1);
-  ClearToSend();
+  previous_millis_cmd = millis();
+  SendOk(buflen); // answers a serial line, whatever is being executed
 }
 
 void ClearToSend()
 {
   previous_millis_cmd = millis();
-  #ifdef SDSUPPORT
-  if(fromsd[bufindr])
+  if(cmdbuffer[bufindr] & CMD_QUIET)
     return;
-  #endif //SDSUPPORT
-  SERIAL_PROTOCOLLNPGM(MSG_OK);
+  SendOk(buflen);
+}
+
+// Acknowledge a line.  With ADVANCED_OK the host is also told the last accepted line
+// number and how much room is left, e.g. "ok N123 P14 B3": P is free planner blocks and
+// B free command buffer slots, given that 'queued' slots are still taken.
+void SendOk(uint8_t queued)
+{
+  #ifdef ADVANCED_OK
+    SERIAL_PROTOCOLPGM(MSG_OK);
+    SERIAL_PROTOCOLPGM(" N");
+    SERIAL_PROTOCOL(gcode_LastN);
+    SERIAL_PROTOCOLPGM(" P");
+    SERIAL_PROTOCOL((int)(BLOCK_BUFFER_SIZE - 1 - movesplanned()));
+    SERIAL_PROTOCOLPGM(" B");
+    SERIAL_PROTOCOLLN((int)(BUFSIZE - queued));
+  #else
+    SERIAL_PROTOCOLLNPGM(MSG_OK);
+  #endif
 }
 
 void get_coordinates()
@@ -3045,6 +3826,9 @@ void get_coordinates()
   if(code_seen('F')) {
     next_feedrate = code_value();
     if(next_feedrate > 0.0) feedrate = next_feedrate;
+    #ifdef POWER_LOSS_RESUME
+      plan_resume.feedrate = feedrate;
+    #endif
   }
   #ifdef FWRETRACT
   if(autoretract_enabled)
@@ -3389,6 +4173,27 @@ void manage_inactivity()
   #ifdef TEMP_STAT_LEDS
       handle_status_leds();
   #endif
+  #ifdef AUTO_REPORT
+    auto_report();
+  #endif
+  #ifdef BINARY_TELEMETRY
+    telemetry();
+  #endif
+  #ifdef POWER_LOSS_RESUME
+    plr_checkpoint();
+  #endif
+  #ifdef USB_TX_BUFFER
+    MSerial.drain();
+  #endif
+  #ifdef STEPPER_RAMP_TABLE
+    st_ramp_fill();
+  #endif
+  #ifdef L6470_STEP_VERIFY
+    st_l6470_verify();
+  #endif
+  #ifdef L6470_HEALTH_MONITOR
+    st_l6470_health();
+  #endif
   check_axes_activity();
 }
 
@@ -3409,6 +4214,9 @@ void kill()
 #endif
   SERIAL_ERROR_START;
   SERIAL_ERRORLNPGM(MSG_ERR_KILLED);
+  #ifdef SERIAL_TX_BUFFER
+    MSerial.flushTX(); // Interrupts are off; get the message out before halting
+  #endif
   LCD_ALERTMESSAGEPGM(MSG_KILLED);
   suicide();
   while(1) { /* Intentionally left empty */ } // Wait for reset
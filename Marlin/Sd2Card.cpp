@@ -152,6 +152,10 @@ static void spiSend(uint8_t data) {
 //------------------------------------------------------------------------------
 // send command and return error code.  Return zero for OK
 uint8_t Sd2Card::cardCommand(uint8_t cmd, uint32_t arg) {
+#ifdef SD_READ_STREAM
+  // end an open multiple block read before anything else
+  if (inStream_ && cmd != CMD12) readStop();
+#endif
   // select card
   chipSelectLow();
 
@@ -286,6 +290,9 @@ bool Sd2Card::eraseSingleBlockEnable() {
 bool Sd2Card::init(uint8_t sckRateID, uint8_t chipSelectPin) {
   errorCode_ = type_ = 0;
   chipSelectPin_ = chipSelectPin;
+#ifdef SD_READ_STREAM
+  inStream_ = false;
+#endif
   // 16-bit init start time allows over a minute
   uint16_t t0 = (uint16_t)millis();
   uint32_t arg;
@@ -462,6 +469,33 @@ bool Sd2Card::readStart(uint32_t blockNumber) {
   chipSelectHigh();
   return false;
 }
+#ifdef SD_READ_STREAM
+//------------------------------------------------------------------------------
+/** Read a block as part of a multiple block read that stays open between calls.
+ *
+ * \param[in] blockNumber Logical block to be read.
+ * \param[out] dst Pointer to the location that will receive the data.
+ *
+ * \note A block that follows the last one read comes from the open sequence
+ * without a new command; any other block restarts it.  The next command sent
+ * to the card for any other purpose ends the sequence with CMD12.
+ *
+ * \return The value one, true, is returned for success and
+ * the value zero, false, is returned for failure.
+ */
+bool Sd2Card::readStream(uint32_t blockNumber, uint8_t* dst) {
+  if (!inStream_ || blockNumber != streamBlock_) {
+    if (!readStart(blockNumber)) return false;
+    inStream_ = true;
+  }
+  if (!readData(dst)) {
+    readStop();
+    return false;
+  }
+  streamBlock_ = blockNumber + 1;
+  return true;
+}
+#endif  // SD_READ_STREAM
 //------------------------------------------------------------------------------
 /** End a read multiple blocks sequence.
  *
@@ -469,6 +503,9 @@ bool Sd2Card::readStart(uint32_t blockNumber) {
  * the value zero, false, is returned for failure.
  */
 bool Sd2Card::readStop() {
+#ifdef SD_READ_STREAM
+  inStream_ = false;
+#endif
   chipSelectLow();
   if (cardCommand(CMD12, 0)) {
     error(SD_CARD_ERROR_CMD12);
@@ -204,6 +204,9 @@ class Sd2Card {
   bool readData(uint8_t *dst);
   bool readStart(uint32_t blockNumber);
   bool readStop();
+#ifdef SD_READ_STREAM
+  bool readStream(uint32_t blockNumber, uint8_t* dst);
+#endif
   bool setSckRate(uint8_t sckRateID);
   /** Return the card type: SD V1, SD V2 or SDHC
    * \return 0 - SD V1, 1 - SD V2, or 3 - SDHC.
@@ -220,6 +223,10 @@ class Sd2Card {
   uint8_t spiRate_;
   uint8_t status_;
   uint8_t type_;
+#ifdef SD_READ_STREAM
+  bool inStream_;          // a multiple block read is open
+  uint32_t streamBlock_;   // the block it delivers next
+#endif
   // private functions
   uint8_t cardAcmd(uint8_t cmd, uint32_t arg) {
     cardCommand(CMD55, 0);
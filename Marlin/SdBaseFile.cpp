@@ -93,6 +93,9 @@ dir_t* SdBaseFile::cacheDirEntry(uint8_t action) {
 bool SdBaseFile::close() {
   bool rtn = sync();
   type_ = FAT_FILE_TYPE_CLOSED;
+#ifdef SD_EXTENTS
+  extents_ = 0;
+#endif
   return rtn;
 }
 //------------------------------------------------------------------------------
@@ -128,6 +131,42 @@ bool SdBaseFile::contiguousRange(uint32_t* bgnBlock, uint32_t* endBlock) {
  fail:
   return false;
 }
+#ifdef SD_EXTENTS
+//------------------------------------------------------------------------------
+/** Resolve the cluster chain of a file opened for read into runs of
+ * consecutive clusters, so that read() and seekSet() need not access the FAT.
+ *
+ * \param[out] extents Where to keep the runs until the file is closed.
+ * A chain with more runs than fit is followed through the FAT past them.
+ *
+ * \return The value one, true, is returned for success and
+ * the value zero, false, is returned for failure.
+ */
+bool SdBaseFile::cacheExtents(fat_extents_t* extents) {
+  extents_ = 0;
+  extents->count = 0;
+  if (!isFile() || (flags_ & O_WRITE)) goto fail;
+
+  for (uint32_t c = firstCluster_; c && !vol_->isEOC(c); ) {
+    uint8_t i = extents->count;
+    if (i && c == extents->run[i - 1].start + extents->run[i - 1].length
+      && extents->run[i - 1].length != 0XFFFF) {
+      extents->run[i - 1].length++;
+    } else {
+      if (i == SD_EXTENTS) break;
+      extents->run[i].start = c;
+      extents->run[i].length = 1;
+      extents->count++;
+    }
+    if (!vol_->fatGet(c, &c)) goto fail;
+  }
+  extents_ = extents;
+  return true;
+
+ fail:
+  return false;
+}
+#endif  // SD_EXTENTS
 //------------------------------------------------------------------------------
 /** Create and open a new contiguous file of a specified size.
  *
@@ -1068,8 +1107,8 @@ int16_t SdBaseFile::read(void* buf, uint16_t nbyte) {
           // use first cluster in file
           curCluster_ = firstCluster_;
         } else {
-          // get next cluster from FAT
-          if (!vol_->fatGet(curCluster_, &curCluster_)) goto fail;
+          // get next cluster
+          if (!nextCluster()) goto fail;
         }
       }
       block = vol_->clusterStartBlock(curCluster_) + blockOfCluster;
@@ -1081,7 +1120,12 @@ int16_t SdBaseFile::read(void* buf, uint16_t nbyte) {
 
     // no buffering needed if n == 512
     if (n == 512 && block != vol_->cacheBlockNumber()) {
+#ifdef SD_READ_STREAM
+      // consecutive blocks, within a cluster or across adjacent ones, need no new command
+      if (!vol_->readStream(block, dst)) goto fail;
+#else
       if (!vol_->readBlock(block, dst)) goto fail;
+#endif
     } else {
       // read block to cache and copy data to caller
       if (!vol_->cacheRawBlock(block, SdVolume::CACHE_FOR_READ)) goto fail;
@@ -1443,6 +1487,9 @@ bool SdBaseFile::rmRfStar() {
 SdBaseFile::SdBaseFile(const char* path, uint8_t oflag) {
   type_ = FAT_FILE_TYPE_CLOSED;
   writeError = false;
+#ifdef SD_EXTENTS
+  extents_ = 0;
+#endif
   open(path, oflag);
 }
 //------------------------------------------------------------------------------
@@ -1473,6 +1520,20 @@ bool SdBaseFile::seekSet(uint32_t pos) {
   nCur = (curPosition_ - 1) >> (vol_->clusterSizeShift_ + 9);
   nNew = (pos - 1) >> (vol_->clusterSizeShift_ + 9);
 
+#ifdef SD_EXTENTS
+  if (extents_) {
+    // look the cluster up in the runs if they reach that far
+    uint32_t n = nNew;
+    for (uint8_t i = 0; i < extents_->count; i++) {
+      if (n < extents_->run[i].length) {
+        curCluster_ = extents_->run[i].start + n;
+        curPosition_ = pos;
+        goto done;
+      }
+      n -= extents_->run[i].length;
+    }
+  }
+#endif  // SD_EXTENTS
   if (nNew < nCur || curPosition_ == 0) {
     // must follow chain from first cluster
     curCluster_ = firstCluster_;
@@ -1481,7 +1542,7 @@ bool SdBaseFile::seekSet(uint32_t pos) {
     nNew -= nCur;
   }
   while (nNew--) {
-    if (!vol_->fatGet(curCluster_, &curCluster_)) goto fail;
+    if (!nextCluster()) goto fail;
   }
   curPosition_ = pos;
 
@@ -1492,6 +1553,29 @@ bool SdBaseFile::seekSet(uint32_t pos) {
   return false;
 }
 //------------------------------------------------------------------------------
+// advance curCluster_ to the next cluster of the chain
+bool SdBaseFile::nextCluster() {
+#ifdef SD_EXTENTS
+  if (extents_) {
+    for (uint8_t i = 0; i < extents_->count; i++) {
+      uint32_t n = curCluster_ - extents_->run[i].start;
+      if (n < extents_->run[i].length) {
+        if (n + 1 < extents_->run[i].length) {
+          curCluster_++;
+          return true;
+        }
+        if (i + 1 < extents_->count) {
+          curCluster_ = extents_->run[i + 1].start;
+          return true;
+        }
+        break;
+      }
+    }
+  }
+#endif  // SD_EXTENTS
+  return vol_->fatGet(curCluster_, &curCluster_);
+}
+//------------------------------------------------------------------------------
 void SdBaseFile::setpos(fpos_t* pos) {
   curPosition_ = pos->position;
   curCluster_ = pos->cluster;
@@ -174,6 +174,23 @@ static inline uint8_t FAT_SECOND(uint16_t fatTime) {
 uint16_t const FAT_DEFAULT_DATE = ((2000 - 1980) << 9) | (1 << 5) | 1;
 /** Default time for file timestamp is 1 am */
 uint16_t const FAT_DEFAULT_TIME = (1 << 11);
+#ifdef SD_EXTENTS
+//------------------------------------------------------------------------------
+/**
+ * \struct fat_extents_t
+ * \brief A cluster chain as runs of consecutive clusters
+ */
+struct fat_extents_t {
+  /** runs in use */
+  uint8_t count;
+  struct {
+    /** first cluster of the run */
+    uint32_t start;
+    /** clusters in the run */
+    uint16_t length;
+  } run[SD_EXTENTS];
+};
+#endif  // SD_EXTENTS
 //------------------------------------------------------------------------------
 /**
  * \class SdBaseFile
@@ -182,7 +199,11 @@ uint16_t const FAT_DEFAULT_TIME = (1 << 11);
 class SdBaseFile {
  public:
   /** Create an instance. */
-  SdBaseFile() : writeError(false), type_(FAT_FILE_TYPE_CLOSED) {}
+  SdBaseFile() : writeError(false), type_(FAT_FILE_TYPE_CLOSED) {
+#ifdef SD_EXTENTS
+    extents_ = 0;
+#endif
+  }
   SdBaseFile(const char* path, uint8_t oflag);
   ~SdBaseFile() {if(isOpen()) close();}
   /**
@@ -204,6 +225,9 @@ class SdBaseFile {
   //----------------------------------------------------------------------------
   bool close();
   bool contiguousRange(uint32_t* bgnBlock, uint32_t* endBlock);
+#ifdef SD_EXTENTS
+  bool cacheExtents(fat_extents_t* extents);
+#endif
   bool createContiguous(SdBaseFile* dirFile,
           const char* path, uint32_t size);
   /** \return The current cluster number for a file or directory. */
@@ -345,12 +369,16 @@ class SdBaseFile {
   uint32_t  fileSize_;      // file size in bytes
   uint32_t  firstCluster_;  // first cluster of file
   SdVolume* vol_;           // volume where file is located
+#ifdef SD_EXTENTS
+  fat_extents_t* extents_;  // cluster chain resolved by cacheExtents(), or 0
+#endif
 
   /** experimental don't use */
   bool openParent(SdBaseFile* dir);
   // private functions
   bool addCluster();
   bool addDirCluster();
+  bool nextCluster();
   dir_t* cacheDirEntry(uint8_t action);
   int8_t lsPrintNext( uint8_t flags, uint8_t indent);
   static bool make83Name(const char* str, uint8_t* name, const char** ptr);
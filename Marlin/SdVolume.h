@@ -188,6 +188,10 @@ class SdVolume {
   }
   bool readBlock(uint32_t block, uint8_t* dst) {
     return sdCard_->readBlock(block, dst);}
+#ifdef SD_READ_STREAM
+  bool readStream(uint32_t block, uint8_t* dst) {
+    return sdCard_->readStream(block, dst);}
+#endif
   bool writeBlock(uint32_t block, const uint8_t* dst) {
     return sdCard_->writeBlock(block, dst);
   }
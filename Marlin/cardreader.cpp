@@ -4,15 +4,23 @@
 #include "stepper.h"
 #include "temperature.h"
 #include "language.h"
+#include "powerloss.h"
 
 #ifdef SDSUPPORT
 
+#ifdef SD_BINARY_UPLOAD
+#include <util/crc16.h>
+#endif
 
 
 CardReader::CardReader()
 {
    filesize = 0;
    sdpos = 0;
+   #ifdef SD_READAHEAD_BLOCKS
+   readahead_pos = readahead_end = readahead;
+   readahead_next = 0;
+   #endif
    sdprinting = false;
    cardOK = false;
    saving = false;
@@ -21,6 +29,9 @@ CardReader::CardReader()
    workDirDepth = 0;
    file_subcall_ctr=0;
    memset(workDirParents, 0, sizeof(workDirParents));
+   #ifdef SD_DIR_INDEX
+   dirIndexCount = -1;
+   #endif
 
    autostart_stilltocheck=true; //the sd start is delayed, because otherwise the serial cannot answer fast enought to make contact with the hostsoftware.
    lastnr=0;
@@ -49,14 +60,32 @@ char *createFilename(char *buffer,const dir_t &p) //buffer>12characters
   return buffer;
 }
 
+#ifdef SD_DIR_INDEX
+static uint16_t nameHash(const char *name)
+{
+  uint16_t hash = 0;
+  while(*name)
+    hash = hash * 31 + toupper(*name++);
+  return hash;
+}
+#endif
+
 
 void  CardReader::lsDive(const char *prepend,SdFile parent)
 {
   dir_t p;
  uint8_t cnt=0;
+#ifdef SD_DIR_INDEX
+  uint16_t first = parent.curPosition() >> 5; // where the next readDir starts
+#endif
  
   while (parent.readDir(p, longFilename) > 0)
   {
+#ifdef SD_DIR_INDEX
+    uint16_t entry = (parent.curPosition() >> 5) - 1;
+    uint16_t lead = entry - first;
+    first = entry + 1;
+#endif
     if( DIR_IS_SUBDIR(&p) && lsAction!=LS_Count && lsAction!=LS_GetFilename) // hence LS_SerialPrint
     {
 
@@ -120,6 +149,15 @@ void  CardReader::lsDive(const char *prepend,SdFile parent)
       }
       else if(lsAction==LS_Count)
       {
+        #ifdef SD_DIR_INDEX
+        if(nrFiles < SD_DIR_INDEX)
+        {
+          sd_index_t &i = dirIndex[nrFiles];
+          i.hash = nameHash(filename);
+          i.entry = entry;
+          i.lead = (lead <= SD_INDEX_LEAD ? lead : 0) | (filenameIsDir ? SD_INDEX_DIR : 0);
+        }
+        #endif
         nrFiles++;
       } 
       else if(lsAction==LS_GetFilename)
@@ -177,6 +215,9 @@ void CardReader::initsd()
   }
   workDir=root;
   curDir=&root;
+  #ifdef SD_DIR_INDEX
+  dropIndex();
+  #endif
   /*
   if(!workDir.openRoot(&volume))
   {
@@ -195,6 +236,9 @@ void CardReader::setroot()
   workDir=root;
   
   curDir=&workDir;
+  #ifdef SD_DIR_INDEX
+  dropIndex();
+  #endif
 }
 void CardReader::release()
 {
@@ -207,6 +251,11 @@ void CardReader::startFileprint()
   if(cardOK)
   {
     sdprinting = true;
+    #ifdef POWER_LOSS_RESUME
+      char name[MAXPATHNAMELENGTH];
+      getAbsFilename(name);
+      plr_start(name, sdpos == 0);
+    #endif
   }
 }
 
@@ -340,14 +389,25 @@ void CardReader::openFile(char* name,bool read, bool replace_current/*=true*/)
   }
   if(read)
   {
-    if (file.open(curDir, fname, O_READ)) 
+    if (
+    #ifdef SD_DIR_INDEX
+        (curDir == &workDir && openIndexed(fname)) ||
+    #endif
+        file.open(curDir, fname, O_READ))
     {
       filesize = file.fileSize();
+      #ifdef SD_EXTENTS
+      file.cacheExtents(&extents);
+      #endif
       SERIAL_PROTOCOLPGM(MSG_SD_FILE_OPENED);
       SERIAL_PROTOCOL(fname);
       SERIAL_PROTOCOLPGM(MSG_SD_SIZE);
       SERIAL_PROTOCOLLN(filesize);
       sdpos = 0;
+      #ifdef SD_READAHEAD_BLOCKS
+      readahead_pos = readahead_end;
+      readahead_next = 0;
+      #endif
       
       SERIAL_PROTOCOLLNPGM(MSG_SD_FILE_SELECTED);
       lcd_setstatus(fname);
@@ -361,6 +421,9 @@ void CardReader::openFile(char* name,bool read, bool replace_current/*=true*/)
   }
   else 
   { //write
+    #ifdef SD_DIR_INDEX
+    dropIndex();
+    #endif
     if (!file.open(curDir, fname, O_CREAT | O_APPEND | O_WRITE | O_TRUNC))
     {
       SERIAL_PROTOCOLPGM(MSG_SD_OPEN_FILE_FAIL);
@@ -434,6 +497,9 @@ void CardReader::removeFile(char* name)
   {
     curDir=&workDir;
   }
+    #ifdef SD_DIR_INDEX
+    dropIndex();
+    #endif
     if (file.remove(curDir, fname)) 
     {
       SERIAL_PROTOCOLPGM("File deleted:");
@@ -449,6 +515,73 @@ void CardReader::removeFile(char* name)
   
 }
 
+#ifdef SD_READAHEAD_BLOCKS
+// Refill the read-ahead buffer, up to a block boundary so that after a seek every later
+// fill is whole blocks, which SdBaseFile::read() moves from the card without the cache
+bool CardReader::readAhead()
+{
+  int16_t n = file.read(readahead, sizeof(readahead) - (readahead_next & 0x1FF));
+  if(n <= 0) {
+    sdpos = readahead_next;
+    return false;
+  }
+  readahead_pos = readahead;
+  readahead_end = readahead + n;
+  return true;
+}
+#endif
+
+#ifdef SD_READ_STREAM
+static void report_read_rate(const char *name, uint16_t blocks, unsigned long ms)
+{
+  SERIAL_ECHO_START;
+  serialprintPGM(name);
+  SERIAL_ECHO(ms);
+  SERIAL_ECHOPGM(" ms, ");
+  SERIAL_ECHO(ms ? (unsigned long)blocks * 500 / ms : 0);  // 512 byte blocks to KB/s
+  SERIAL_ECHOLNPGM(" KB/s");
+}
+
+// Read the first blocks of the card one command each (CMD17), then the same blocks
+// as one stream (CMD18), and report how long each took.  Goes through the volume
+// cache, which is left empty, so it is refused while a file is open.
+void CardReader::readBenchmark(uint16_t blocks)
+{
+  if(!cardOK || sdprinting || saving || isFileOpen()) {
+    SERIAL_ERROR_START;
+    SERIAL_ERRORLNPGM(MSG_SD_BENCH_BUSY);
+    return;
+  }
+  cache_t *cache = volume.cacheClear();
+  if(cache == NULL)
+    return;
+  uint8_t *buf = cache->data;
+
+  unsigned long t = millis();
+  uint16_t i;
+  for(i = 0; i < blocks && card.readBlock(i, buf); i++);
+  t = millis() - t;
+  if(i < blocks) {
+    SERIAL_ERROR_START;
+    SERIAL_ERRORLNPGM(MSG_SD_READ_FAILED);
+    return;
+  }
+  report_read_rate(PSTR("CMD17 single: "), blocks, t);
+
+  t = millis();
+  for(i = 0; i < blocks && card.readStream(i, buf); i++);
+  if(i == blocks)
+    card.readStop();
+  t = millis() - t;
+  if(i < blocks) {
+    SERIAL_ERROR_START;
+    SERIAL_ERRORLNPGM(MSG_SD_READ_FAILED);
+    return;
+  }
+  report_read_rate(PSTR("CMD18 stream: "), blocks, t);
+}
+#endif // SD_READ_STREAM
+
 void CardReader::getStatus()
 {
   if(cardOK){
@@ -484,6 +617,113 @@ void CardReader::write_command(char *buf)
   }
 }
 
+#ifdef SD_BINARY_UPLOAD
+// Binary upload (M35).  After "Upload ready" the host sends chunks of
+//   SD_UPLOAD_SYNC, chunk number (u16), data length (u16, at most SD_UPLOAD_CHUNK),
+//   the data and a CRC-16 (XMODEM) over number, length and data,
+// all low byte first, numbering from 0.  "ack <n>" says chunks up to n are written; the
+// host may be up to the announced window of chunks ahead of it.  A damaged or out of
+// order chunk is answered "rs <n>", unless a resend is already outstanding, and the
+// chunks after it are dropped until chunk n comes again.  When the acks stop the host
+// should resend from the first chunk not acknowledged.  A chunk without data ends the
+// upload.  Chunks of SD_UPLOAD_CHUNK bytes keep every write a whole block.
+#define SD_UPLOAD_SYNC     0xB6
+#define SD_UPLOAD_CHUNK    512
+#define SD_UPLOAD_TIMEOUT  5000  // ms without data before the upload is given up
+#ifdef AT90USB
+  #define SD_UPLOAD_WINDOW 8     // USB holds the host off while a block is written
+#else
+  #define SD_UPLOAD_WINDOW 1     // the UART receive buffer cannot hold a chunk
+#endif
+
+// The next byte from the host, or -1 after SD_UPLOAD_TIMEOUT.  Keeps the heaters and
+// the serial output going while it waits, but not the LCD, whose SD menu would open
+// and close files under the upload.
+static int16_t upload_byte()
+{
+  unsigned long start = millis();
+  while(!MYSERIAL.available()) {
+    manage_heater();
+    manage_inactivity();
+    if(millis() - start > SD_UPLOAD_TIMEOUT)
+      return -1;
+  }
+  return MYSERIAL.read();
+}
+
+static void upload_reply(const char *msg, uint16_t n)
+{
+  serialprintPGM(msg);
+  SERIAL_PROTOCOLLN(n);
+  #ifdef USB_TX_BUFFER
+    MSerial.drain();
+  #endif
+}
+
+void CardReader::binaryUpload()
+{
+  uint8_t *chunk = readahead;  // not printing while the file is open for writing
+  uint16_t expected = 0;
+  bool resend = false;
+  int16_t c;
+
+  SERIAL_PROTOCOLPGM(MSG_SD_UPLOAD_READY);
+  SERIAL_PROTOCOLLN(SD_UPLOAD_WINDOW);
+  for(;;) {
+    if((c = upload_byte()) < 0)
+      break;
+    if(c != SD_UPLOAD_SYNC)
+      continue;  // whatever came between chunks
+
+    uint8_t head[4];
+    uint16_t crc = 0;
+    for(uint8_t i = 0; i < 4 && (c = upload_byte()) >= 0; i++) {
+      head[i] = c;
+      crc = _crc_xmodem_update(crc, c);
+    }
+    uint16_t n = head[0] | (head[1] << 8);
+    uint16_t len = head[2] | (head[3] << 8);
+    if(c >= 0 && len <= SD_UPLOAD_CHUNK) {
+      for(uint16_t i = 0; i < len && (c = upload_byte()) >= 0; i++) {
+        chunk[i] = c;
+        crc = _crc_xmodem_update(crc, c);
+      }
+      if(c >= 0 && (c = upload_byte()) >= 0)
+        crc ^= c;
+      if(c >= 0 && (c = upload_byte()) >= 0)
+        crc ^= c << 8;
+    }
+    if(c < 0)
+      break;
+
+    if(len > SD_UPLOAD_CHUNK || crc || n != expected) {
+      if((uint16_t)(expected - n) <= SD_UPLOAD_WINDOW && n != expected && !crc && len <= SD_UPLOAD_CHUNK)
+        upload_reply(PSTR("ack "), expected - 1);  // a resend of chunks already written
+      else if(!resend) {
+        upload_reply(PSTR("rs "), expected);
+        resend = true;
+      }
+      continue;
+    }
+    resend = false;
+    if(len == 0) {
+      closefile();
+      SERIAL_PROTOCOLLNPGM(MSG_FILE_SAVED);
+      return;
+    }
+    if(file.write(chunk, len) != (int16_t)len) {
+      SERIAL_ERROR_START;
+      SERIAL_ERRORLNPGM(MSG_SD_ERR_WRITE_TO_FILE);
+      closefile();
+      return;
+    }
+    upload_reply(PSTR("ack "), expected++);
+  }
+  SERIAL_ERROR_START;
+  SERIAL_ERRORLNPGM(MSG_SD_UPLOAD_TIMEOUT);
+  closefile();
+}
+#endif // SD_BINARY_UPLOAD
 
 void CardReader::checkautostart(bool force)
 {
@@ -555,6 +795,21 @@ void CardReader::closefile(bool store_location)
 void CardReader::getfilename(const uint8_t nr)
 {
   curDir=&workDir;
+  #ifdef SD_DIR_INDEX
+  if(nr < dirIndexCount && nr < SD_DIR_INDEX)
+  {
+    // Read the long name entries in front of it and the 8.3 entry
+    const sd_index_t &i = dirIndex[nr];
+    dir_t p;
+    curDir->seekSet(32UL * (i.entry - (i.lead & SD_INDEX_LEAD)));
+    if(curDir->readDir(p, longFilename) > 0)
+    {
+      createFilename(filename,p);
+      filenameIsDir=DIR_IS_SUBDIR(&p);
+      return;
+    }
+  }
+  #endif
   lsAction=LS_GetFilename;
   nrFiles=nr;
   curDir->rewind();
@@ -565,14 +820,43 @@ void CardReader::getfilename(const uint8_t nr)
 uint16_t CardReader::getnrfilenames()
 {
   curDir=&workDir;
+  #ifdef SD_DIR_INDEX
+  if(dirIndexCount >= 0)
+    return dirIndexCount;
+  #endif
   lsAction=LS_Count;
   nrFiles=0;
   curDir->rewind();
   lsDive("",*curDir);
   //SERIAL_ECHOLN(nrFiles);
+  #ifdef SD_DIR_INDEX
+  dirIndexCount = nrFiles;
+  #endif
   return nrFiles;
 }
 
+#ifdef SD_DIR_INDEX
+// Open name for reading if the index of workDir has it
+bool CardReader::openIndexed(const char *name)
+{
+  if(dirIndexCount < 0)
+    return false;
+  uint16_t hash = nameHash(name);
+  for(int16_t n = 0; n < dirIndexCount && n < SD_DIR_INDEX; n++)
+  {
+    const sd_index_t &i = dirIndex[n];
+    if(i.hash != hash || (i.lead & SD_INDEX_DIR) || !file.open(&workDir, i.entry, O_READ))
+      continue;
+    char found[13];
+    file.getFilename(found);
+    if(strcasecmp(found, name) == 0)
+      return true;
+    file.close();
+  }
+  return false;
+}
+#endif
+
 void CardReader::chdir(const char * relpath)
 {
   SdFile newfile;
@@ -595,6 +879,9 @@ void CardReader::chdir(const char * relpath)
       workDirParents[0]=*parent;
     }
     workDir=newfile;
+    #ifdef SD_DIR_INDEX
+    dropIndex();
+    #endif
   }
 }
 
@@ -607,6 +894,9 @@ void CardReader::updir()
     int d;
     for (int d = 0; d < workDirDepth; d++)
       workDirParents[d] = workDirParents[d+1];
+    #ifdef SD_DIR_INDEX
+    dropIndex();
+    #endif
   }
 }
 
@@ -627,6 +917,9 @@ void CardReader::printingHasFinished()
       quickStop();
       file.close();
       sdprinting = false;
+      #ifdef POWER_LOSS_RESUME
+        plr_finish();
+      #endif
       if(SD_FINISHED_STEPPERRELEASE)
       {
           //finishAndDisableSteppers();
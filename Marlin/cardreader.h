@@ -5,8 +5,23 @@
 
 #define MAX_DIR_DEPTH 10
 
+#if defined(SD_BINARY_UPLOAD) && !defined(SD_READAHEAD_BLOCKS)
+  #error SD_BINARY_UPLOAD needs the SD_READAHEAD_BLOCKS buffer
+#endif
+
 #include "SdFile.h"
 enum LsAction {LS_SerialPrint,LS_Count,LS_GetFilename};
+
+#ifdef SD_DIR_INDEX
+// Where lsDive found a file of the working directory
+typedef struct {
+  uint16_t hash;   // of the 8.3 name, in any case
+  uint16_t entry;  // the 8.3 entry, in 32-byte entries from the start of the directory
+  uint8_t lead;    // entries before it that readDir goes through for the long name; SD_INDEX_DIR
+} sd_index_t;
+#define SD_INDEX_DIR  0x80  // a subdirectory
+#define SD_INDEX_LEAD 0x7f
+#endif
 class CardReader
 {
 public:
@@ -14,6 +29,9 @@ public:
   
   void initsd();
   void write_command(char *buf);
+#ifdef SD_BINARY_UPLOAD
+  void binaryUpload();  // receive the file opened for writing as binary chunks
+#endif
   //files auto[0-9].g on the sd card are performed in a row
   //this is to delay autostart and hence the initialisaiton of the sd card to some seconds after the normal init, so the device is available quick after a reset
 
@@ -26,6 +44,9 @@ public:
   void startFileprint();
   void pauseSDPrint();
   void getStatus();
+#ifdef SD_READ_STREAM
+  void readBenchmark(uint16_t blocks);  // time single block reads against a stream
+#endif
   void printingHasFinished();
 
   void getfilename(const uint8_t nr);
@@ -42,8 +63,18 @@ public:
 
   FORCE_INLINE bool isFileOpen() { return file.isOpen(); }
   FORCE_INLINE bool eof() { return sdpos>=filesize ;};
+#ifdef SD_READAHEAD_BLOCKS
+  FORCE_INLINE int16_t get() {
+    if(readahead_pos == readahead_end && !readAhead()) return -1;
+    sdpos = readahead_next++;
+    return *readahead_pos++;
+  };
+  FORCE_INLINE void setIndex(long index) {sdpos = readahead_next = index; readahead_pos = readahead_end; file.seekSet(index);};
+#else
   FORCE_INLINE int16_t get() {  sdpos = file.curPosition();return (int16_t)file.read();};
   FORCE_INLINE void setIndex(long index) {sdpos = index;file.seekSet(index);};
+#endif
+  FORCE_INLINE uint32_t getIndex() { return sdpos; };
   FORCE_INLINE uint8_t percentDone(){if(!isFileOpen()) return 0; if(filesize) return sdpos/((filesize+99)/100); else return 0;};
   FORCE_INLINE char* getWorkDirName(){workDir.getFilename(filename);return filename;};
 
@@ -62,6 +93,9 @@ private:
   Sd2Card card;
   SdVolume volume;
   SdFile file;
+#ifdef SD_EXTENTS
+  fat_extents_t extents;  // cluster chain of file while it is open for printing
+#endif
   #define SD_PROCEDURE_DEPTH 1
   #define MAXPATHNAMELENGTH (13*MAX_DIR_DEPTH+MAX_DIR_DEPTH+1)
   uint8_t file_subcall_ctr;
@@ -71,6 +105,12 @@ private:
   //int16_t n;
   unsigned long autostart_atmillis;
   uint32_t sdpos ;
+#ifdef SD_READAHEAD_BLOCKS
+  uint8_t readahead[SD_READAHEAD_BLOCKS * 512];
+  uint8_t *readahead_pos, *readahead_end;  // next byte for get(), end of the data read
+  uint32_t readahead_next;                 // file position of *readahead_pos
+  bool readAhead();
+#endif
 
   bool autostart_stilltocheck; //the sd start is delayed, because otherwise the serial cannot answer fast enought to make contact with the hostsoftware.
   
@@ -78,6 +118,12 @@ private:
   int16_t nrFiles; //counter for the files in the current directory and recycled as position counter for getting the nrFiles'th name in the directory.
   char* diveDirName;
   void lsDive(const char *prepend,SdFile parent);
+#ifdef SD_DIR_INDEX
+  sd_index_t dirIndex[SD_DIR_INDEX];
+  int16_t dirIndexCount;  // files in workDir, -1 until LS_Count has indexed it
+  bool openIndexed(const char *name);
+  FORCE_INLINE void dropIndex() { dirIndexCount = -1; }
+#endif
 };
 extern CardReader card;
 #define IS_SD_PRINTING (card.sdprinting)
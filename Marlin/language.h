@@ -190,12 +190,31 @@
 	#define MSG_SD_PRINTING_BYTE "SD printing byte "
 	#define MSG_SD_NOT_PRINTING "Not SD printing"
 	#define MSG_SD_ERR_WRITE_TO_FILE "error writing to file"
+	#define MSG_SD_BENCH_BUSY "Card busy or not ready"
+	#define MSG_SD_BENCH_BLOCKS "Blocks must be 1 to 65535"
+	#define MSG_SD_READ_FAILED "Read failed"
 	#define MSG_SD_CANT_ENTER_SUBDIR "Cannot enter subdir: "
+	#define MSG_NOT_WHILE_SD_PRINTING "Not while SD printing"
+	#define MSG_PLR_NOTHING "No print to resume"
+	#define MSG_SD_UPLOAD_READY "Upload ready window:"
+	#define MSG_SD_UPLOAD_TIMEOUT "Upload timed out"
 
 	#define MSG_STEPPER_TOO_HIGH "Steprate too high: "
 	#define MSG_ENDSTOPS_HIT "endstops hit: "
 	#define MSG_ERR_COLD_EXTRUDE_STOP " cold extrusion prevented"
 	#define MSG_ERR_LONG_EXTRUDE_STOP " too long extrusion prevented"
+	#define MSG_BINARY_MODE "Binary moves:"
+	#define MSG_BINARY_MODE_INVALID "Binary mode must be 0, 1 or 2"
+	#define MSG_BINARY_NOT_TO_SD "Binary moves cannot be written to SD"
+	#define MSG_BLOCK_REFUSED "Preplanned block refused:"
+	#define MSG_BLOCK_REFUSED_LINE "Preplanned block refused, line: "
+	#define MSG_BLOCK_OUTSIDE_ENDSTOPS " outside the software endstops"
+	#define MSG_BLOCK_STEP_COUNTS " step counts"
+	#define MSG_BLOCK_RATES " rates"
+	#define MSG_BLOCK_FEEDRATE " feedrate"
+	#define MSG_BLOCK_ACCELERATION " acceleration"
+	#define MSG_BLOCK_JERK " jerk"
+	#define MSG_BLOCK_DECELERATION " deceleration"
 
 #endif
 
@@ -358,12 +377,31 @@
 	#define MSG_SD_PRINTING_BYTE "Drukowanie z karty SD, bajt "
 	#define MSG_SD_NOT_PRINTING "Nie trwa drukowanie z karty SD"
 	#define MSG_SD_ERR_WRITE_TO_FILE "blad podczas zapisu do pliku"
+	#define MSG_SD_BENCH_BUSY "Card busy or not ready"
+	#define MSG_SD_BENCH_BLOCKS "Blocks must be 1 to 65535"
+	#define MSG_SD_READ_FAILED "Read failed"
 	#define MSG_SD_CANT_ENTER_SUBDIR "Nie mozna odczytac podkatalogu: "
+	#define MSG_NOT_WHILE_SD_PRINTING "Not while SD printing"
+	#define MSG_PLR_NOTHING "No print to resume"
+	#define MSG_SD_UPLOAD_READY "Upload ready window:"
+	#define MSG_SD_UPLOAD_TIMEOUT "Upload timed out"
 
 	#define MSG_STEPPER_TOO_HIGH "Za duza czestotliwosc krokow: "
 	#define MSG_ENDSTOPS_HIT "Wylacznik krancowy zostal wyzwolony na pozycji: "
 	#define MSG_ERR_COLD_EXTRUDE_STOP " uniemozliwiono zimna ekstruzje"
 	#define MSG_ERR_LONG_EXTRUDE_STOP " uniemozliwiono zbyt dluga ekstruzje"
+	#define MSG_BINARY_MODE "Binary moves:"
+	#define MSG_BINARY_MODE_INVALID "Binary mode must be 0, 1 or 2"
+	#define MSG_BINARY_NOT_TO_SD "Binary moves cannot be written to SD"
+	#define MSG_BLOCK_REFUSED "Preplanned block refused:"
+	#define MSG_BLOCK_REFUSED_LINE "Preplanned block refused, line: "
+	#define MSG_BLOCK_OUTSIDE_ENDSTOPS " outside the software endstops"
+	#define MSG_BLOCK_STEP_COUNTS " step counts"
+	#define MSG_BLOCK_RATES " rates"
+	#define MSG_BLOCK_FEEDRATE " feedrate"
+	#define MSG_BLOCK_ACCELERATION " acceleration"
+	#define MSG_BLOCK_JERK " jerk"
+	#define MSG_BLOCK_DECELERATION " deceleration"
 
 #endif
 
@@ -525,12 +563,31 @@
 	#define MSG_SD_PRINTING_BYTE "Octet impression SD "
 	#define MSG_SD_NOT_PRINTING "Pas d'impression SD"
 	#define MSG_SD_ERR_WRITE_TO_FILE "Erreur d'ecriture dans le fichier"
+	#define MSG_SD_BENCH_BUSY "Card busy or not ready"
+	#define MSG_SD_BENCH_BLOCKS "Blocks must be 1 to 65535"
+	#define MSG_SD_READ_FAILED "Read failed"
 	#define MSG_SD_CANT_ENTER_SUBDIR "Impossible d'entrer dans le sous-repertoire: "
+	#define MSG_NOT_WHILE_SD_PRINTING "Not while SD printing"
+	#define MSG_PLR_NOTHING "No print to resume"
+	#define MSG_SD_UPLOAD_READY "Upload ready window:"
+	#define MSG_SD_UPLOAD_TIMEOUT "Upload timed out"
 
 	#define MSG_STEPPER_TOO_HIGH "Steprate trop eleve: "
 	#define MSG_ENDSTOPS_HIT "Fin de course atteint: "
 	#define MSG_ERR_COLD_EXTRUDE_STOP " Extrusion a froid evitee"
 	#define MSG_ERR_LONG_EXTRUDE_STOP " Extrusion longue evitee"
+	#define MSG_BINARY_MODE "Binary moves:"
+	#define MSG_BINARY_MODE_INVALID "Binary mode must be 0, 1 or 2"
+	#define MSG_BINARY_NOT_TO_SD "Binary moves cannot be written to SD"
+	#define MSG_BLOCK_REFUSED "Preplanned block refused:"
+	#define MSG_BLOCK_REFUSED_LINE "Preplanned block refused, line: "
+	#define MSG_BLOCK_OUTSIDE_ENDSTOPS " outside the software endstops"
+	#define MSG_BLOCK_STEP_COUNTS " step counts"
+	#define MSG_BLOCK_RATES " rates"
+	#define MSG_BLOCK_FEEDRATE " feedrate"
+	#define MSG_BLOCK_ACCELERATION " acceleration"
+	#define MSG_BLOCK_JERK " jerk"
+	#define MSG_BLOCK_DECELERATION " deceleration"
 	
 #endif
 
@@ -695,12 +752,31 @@
 	#define MSG_SD_PRINTING_BYTE "SD printing byte "
 	#define MSG_SD_NOT_PRINTING "Not SD printing"
 	#define MSG_SD_ERR_WRITE_TO_FILE "error writing to file"
+	#define MSG_SD_BENCH_BUSY "Card busy or not ready"
+	#define MSG_SD_BENCH_BLOCKS "Blocks must be 1 to 65535"
+	#define MSG_SD_READ_FAILED "Read failed"
 	#define MSG_SD_CANT_ENTER_SUBDIR "Cannot enter subdir:"
+	#define MSG_NOT_WHILE_SD_PRINTING "Not while SD printing"
+	#define MSG_PLR_NOTHING "No print to resume"
+	#define MSG_SD_UPLOAD_READY "Upload ready window:"
+	#define MSG_SD_UPLOAD_TIMEOUT "Upload timed out"
 
 	#define MSG_STEPPER_TOO_HIGH "Steprate too high : "
 	#define MSG_ENDSTOPS_HIT "endstops hit: "
 	#define MSG_ERR_COLD_EXTRUDE_STOP " cold extrusion prevented"
 	#define MSG_ERR_LONG_EXTRUDE_STOP " too long extrusion prevented"
+	#define MSG_BINARY_MODE "Binary moves:"
+	#define MSG_BINARY_MODE_INVALID "Binary mode must be 0, 1 or 2"
+	#define MSG_BINARY_NOT_TO_SD "Binary moves cannot be written to SD"
+	#define MSG_BLOCK_REFUSED "Preplanned block refused:"
+	#define MSG_BLOCK_REFUSED_LINE "Preplanned block refused, line: "
+	#define MSG_BLOCK_OUTSIDE_ENDSTOPS " outside the software endstops"
+	#define MSG_BLOCK_STEP_COUNTS " step counts"
+	#define MSG_BLOCK_RATES " rates"
+	#define MSG_BLOCK_FEEDRATE " feedrate"
+	#define MSG_BLOCK_ACCELERATION " acceleration"
+	#define MSG_BLOCK_JERK " jerk"
+	#define MSG_BLOCK_DECELERATION " deceleration"
 
 #endif
 
@@ -868,12 +944,31 @@
 	#define MSG_SD_PRINTING_BYTE "SD imprimiendo el byte "
 	#define MSG_SD_NOT_PRINTING "No se esta imprimiendo con SD"
 	#define MSG_SD_ERR_WRITE_TO_FILE "Error al escribir en el archivo"
+	#define MSG_SD_BENCH_BUSY "Card busy or not ready"
+	#define MSG_SD_BENCH_BLOCKS "Blocks must be 1 to 65535"
+	#define MSG_SD_READ_FAILED "Read failed"
 	#define MSG_SD_CANT_ENTER_SUBDIR "No se puede abrir la carpeta:"
+	#define MSG_NOT_WHILE_SD_PRINTING "Not while SD printing"
+	#define MSG_PLR_NOTHING "No print to resume"
+	#define MSG_SD_UPLOAD_READY "Upload ready window:"
+	#define MSG_SD_UPLOAD_TIMEOUT "Upload timed out"
 
 	#define MSG_STEPPER_TOO_HIGH "Steprate demasiado alto : "
 	#define MSG_ENDSTOPS_HIT "Se ha tocado el fin de carril: "
 	#define MSG_ERR_COLD_EXTRUDE_STOP " extrusion fria evitada"
 	#define MSG_ERR_LONG_EXTRUDE_STOP " extrusion demasiado larga evitada"
+	#define MSG_BINARY_MODE "Binary moves:"
+	#define MSG_BINARY_MODE_INVALID "Binary mode must be 0, 1 or 2"
+	#define MSG_BINARY_NOT_TO_SD "Binary moves cannot be written to SD"
+	#define MSG_BLOCK_REFUSED "Preplanned block refused:"
+	#define MSG_BLOCK_REFUSED_LINE "Preplanned block refused, line: "
+	#define MSG_BLOCK_OUTSIDE_ENDSTOPS " outside the software endstops"
+	#define MSG_BLOCK_STEP_COUNTS " step counts"
+	#define MSG_BLOCK_RATES " rates"
+	#define MSG_BLOCK_FEEDRATE " feedrate"
+	#define MSG_BLOCK_ACCELERATION " acceleration"
+	#define MSG_BLOCK_JERK " jerk"
+	#define MSG_BLOCK_DECELERATION " deceleration"
 
 #endif
 
@@ -1032,11 +1127,30 @@
 	#define MSG_SD_PRINTING_BYTE				"SD печать byte "
 	#define MSG_SD_NOT_PRINTING					"нет SD печати"
 	#define MSG_SD_ERR_WRITE_TO_FILE			"ошибка записи в файл"
+	#define MSG_SD_BENCH_BUSY "Card busy or not ready"
+	#define MSG_SD_BENCH_BLOCKS "Blocks must be 1 to 65535"
+	#define MSG_SD_READ_FAILED "Read failed"
 	#define MSG_SD_CANT_ENTER_SUBDIR			"Не зайти в папку:"
+	#define MSG_NOT_WHILE_SD_PRINTING "Not while SD printing"
+	#define MSG_PLR_NOTHING "No print to resume"
+	#define MSG_SD_UPLOAD_READY "Upload ready window:"
+	#define MSG_SD_UPLOAD_TIMEOUT "Upload timed out"
 	#define MSG_STEPPER_TOO_HIGH				"Частота шагов очень высока : "
 	#define MSG_ENDSTOPS_HIT					"концевик сработал: "
 	#define MSG_ERR_COLD_EXTRUDE_STOP			" защита холодной экструзии"
 	#define MSG_ERR_LONG_EXTRUDE_STOP			" защита превышения длинны экструзии"
+	#define MSG_BINARY_MODE "Binary moves:"
+	#define MSG_BINARY_MODE_INVALID "Binary mode must be 0, 1 or 2"
+	#define MSG_BINARY_NOT_TO_SD "Binary moves cannot be written to SD"
+	#define MSG_BLOCK_REFUSED "Preplanned block refused:"
+	#define MSG_BLOCK_REFUSED_LINE "Preplanned block refused, line: "
+	#define MSG_BLOCK_OUTSIDE_ENDSTOPS " outside the software endstops"
+	#define MSG_BLOCK_STEP_COUNTS " step counts"
+	#define MSG_BLOCK_RATES " rates"
+	#define MSG_BLOCK_FEEDRATE " feedrate"
+	#define MSG_BLOCK_ACCELERATION " acceleration"
+	#define MSG_BLOCK_JERK " jerk"
+	#define MSG_BLOCK_DECELERATION " deceleration"
 
 #endif
 
@@ -1197,12 +1311,31 @@
 	#define MSG_SD_PRINTING_BYTE     "Si sta scrivendo il byte su SD "
 	#define MSG_SD_NOT_PRINTING      "Non si sta scrivendo su SD"
 	#define MSG_SD_ERR_WRITE_TO_FILE "Errore nella scrittura su file"
+	#define MSG_SD_BENCH_BUSY "Card busy or not ready"
+	#define MSG_SD_BENCH_BLOCKS "Blocks must be 1 to 65535"
+	#define MSG_SD_READ_FAILED "Read failed"
 	#define MSG_SD_CANT_ENTER_SUBDIR "Impossibile entrare nella sottocartella: "
+	#define MSG_NOT_WHILE_SD_PRINTING "Not while SD printing"
+	#define MSG_PLR_NOTHING "No print to resume"
+	#define MSG_SD_UPLOAD_READY "Upload ready window:"
+	#define MSG_SD_UPLOAD_TIMEOUT "Upload timed out"
 
 	#define MSG_STEPPER_TOO_HIGH     "Steprate troppo alto: "
 	#define MSG_ENDSTOPS_HIT         "Raggiunto il fondo carrello: "
 	#define MSG_ERR_COLD_EXTRUDE_STOP " prevenuta estrusione fredda"
 	#define MSG_ERR_LONG_EXTRUDE_STOP " prevenuta estrusione troppo lunga"
+	#define MSG_BINARY_MODE "Binary moves:"
+	#define MSG_BINARY_MODE_INVALID "Binary mode must be 0, 1 or 2"
+	#define MSG_BINARY_NOT_TO_SD "Binary moves cannot be written to SD"
+	#define MSG_BLOCK_REFUSED "Preplanned block refused:"
+	#define MSG_BLOCK_REFUSED_LINE "Preplanned block refused, line: "
+	#define MSG_BLOCK_OUTSIDE_ENDSTOPS " outside the software endstops"
+	#define MSG_BLOCK_STEP_COUNTS " step counts"
+	#define MSG_BLOCK_RATES " rates"
+	#define MSG_BLOCK_FEEDRATE " feedrate"
+	#define MSG_BLOCK_ACCELERATION " acceleration"
+	#define MSG_BLOCK_JERK " jerk"
+	#define MSG_BLOCK_DECELERATION " deceleration"
 
 #endif
 
@@ -1370,12 +1503,31 @@
 	#define MSG_SD_PRINTING_BYTE "SD imprimindo o byte "
 	#define MSG_SD_NOT_PRINTING "Nao esta se imprimindo com o SD"
 	#define MSG_SD_ERR_WRITE_TO_FILE "Erro ao escrever no arquivo"
+	#define MSG_SD_BENCH_BUSY "Card busy or not ready"
+	#define MSG_SD_BENCH_BLOCKS "Blocks must be 1 to 65535"
+	#define MSG_SD_READ_FAILED "Read failed"
 	#define MSG_SD_CANT_ENTER_SUBDIR "Nao pode abrir o sub diretorio:"
+	#define MSG_NOT_WHILE_SD_PRINTING "Not while SD printing"
+	#define MSG_PLR_NOTHING "No print to resume"
+	#define MSG_SD_UPLOAD_READY "Upload ready window:"
+	#define MSG_SD_UPLOAD_TIMEOUT "Upload timed out"
 
 	#define MSG_STEPPER_TOO_HIGH "Steprate muito alto : "
 	#define MSG_ENDSTOPS_HIT "O ponto final foi tocado: "
 	#define MSG_ERR_COLD_EXTRUDE_STOP " Extrusao a frio evitada"
 	#define MSG_ERR_LONG_EXTRUDE_STOP " Extrusao muito larga evitada"
+	#define MSG_BINARY_MODE "Binary moves:"
+	#define MSG_BINARY_MODE_INVALID "Binary mode must be 0, 1 or 2"
+	#define MSG_BINARY_NOT_TO_SD "Binary moves cannot be written to SD"
+	#define MSG_BLOCK_REFUSED "Preplanned block refused:"
+	#define MSG_BLOCK_REFUSED_LINE "Preplanned block refused, line: "
+	#define MSG_BLOCK_OUTSIDE_ENDSTOPS " outside the software endstops"
+	#define MSG_BLOCK_STEP_COUNTS " step counts"
+	#define MSG_BLOCK_RATES " rates"
+	#define MSG_BLOCK_FEEDRATE " feedrate"
+	#define MSG_BLOCK_ACCELERATION " acceleration"
+	#define MSG_BLOCK_JERK " jerk"
+	#define MSG_BLOCK_DECELERATION " deceleration"
 
 
 #endif
@@ -1539,12 +1691,31 @@
 	#define MSG_SD_PRINTING_BYTE "SD tulostus byte "
 	#define MSG_SD_NOT_PRINTING "Ei SD tulostus"
 	#define MSG_SD_ERR_WRITE_TO_FILE "virhe kirjoitettaessa tiedostoon"
+	#define MSG_SD_BENCH_BUSY "Card busy or not ready"
+	#define MSG_SD_BENCH_BLOCKS "Blocks must be 1 to 65535"
+	#define MSG_SD_READ_FAILED "Read failed"
 	#define MSG_SD_CANT_ENTER_SUBDIR "Alihakemistoon ei voitu siirtya: "
+	#define MSG_NOT_WHILE_SD_PRINTING "Not while SD printing"
+	#define MSG_PLR_NOTHING "No print to resume"
+	#define MSG_SD_UPLOAD_READY "Upload ready window:"
+	#define MSG_SD_UPLOAD_TIMEOUT "Upload timed out"
 
 	#define MSG_STEPPER_TOO_HIGH "Askellustaajuus liian suuri: "
 	#define MSG_ENDSTOPS_HIT "paatyrajat aktivoitu: "
 	#define MSG_ERR_COLD_EXTRUDE_STOP " kylmana pursotus estetty"
 	#define MSG_ERR_LONG_EXTRUDE_STOP " liian pitka pursotus estetty"
+	#define MSG_BINARY_MODE "Binary moves:"
+	#define MSG_BINARY_MODE_INVALID "Binary mode must be 0, 1 or 2"
+	#define MSG_BINARY_NOT_TO_SD "Binary moves cannot be written to SD"
+	#define MSG_BLOCK_REFUSED "Preplanned block refused:"
+	#define MSG_BLOCK_REFUSED_LINE "Preplanned block refused, line: "
+	#define MSG_BLOCK_OUTSIDE_ENDSTOPS " outside the software endstops"
+	#define MSG_BLOCK_STEP_COUNTS " step counts"
+	#define MSG_BLOCK_RATES " rates"
+	#define MSG_BLOCK_FEEDRATE " feedrate"
+	#define MSG_BLOCK_ACCELERATION " acceleration"
+	#define MSG_BLOCK_JERK " jerk"
+	#define MSG_BLOCK_DECELERATION " deceleration"
 
 #endif
 #endif // ifndef LANGUAGE_H
@@ -1595,7 +1595,8 @@
   #define X_L6470_CS_PIN      4 // PD4; pkg pin 29  ICP1
   #define X_L6470_RST_PIN    42 // PF4; pkg pin 57  ADC4 / TCK
   #define X_L6470_BSY_PIN    19 // PE7; pkg pin 02  INT.7 / AIN.1 / UVcon
-  #define X_STOP_PIN         35
+//#define X_L6470_STCK_PIN   -1 // Wire STCK to a free pin to step this driver in step-clock mode
+  #define X_STOP_PIN         35 // PE3; no pin interrupt, always polled
   #define X_MIN_PIN          35
   #define X_MAX_PIN          35
   #define X_L6470_KRUN      230 // KVAL_RUN PWM duty cycle, 230/255 -> 90%
@@ -1612,6 +1613,7 @@
   #define Y_STOP_PIN         12
   #define Y_MIN_PIN 	     12
   #define Y_MAX_PIN	         12
+  #define Y_STOP_PCINT        4 // PB4; PCINT4 (ENDSTOP_INTERRUPTS)
   #define Y_L6470_KRUN      230 // 230/255 -> 90%
   #define Y_L6470_KHOLD      63 //  63/255 -> 25%
   #define Y_L6470_MAX_SPD   600
@@ -1626,6 +1628,7 @@
   #define Z_STOP_PIN         36
   #define Z_MIN_PIN          36
   #define Z_MAX_PIN          36
+  #define Z_STOP_INT          4 // PE4; INT.4 (ENDSTOP_INTERRUPTS)
   #define Z_L6470_KRUN      230 // 230/255 -> 90%
   #define Z_L6470_KHOLD      63 //  63/255 -> 25%
 //#define Z_L6470_MAX_SPD  3000 // May be smoother?
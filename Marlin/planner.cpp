@@ -92,6 +92,14 @@ matrix_3x3 plan_bed_level_matrix = {
 long position[4];   //rescaled from extern when axis_steps_per_unit are changed by gcode
 static float previous_speed[4]; // Speed of previous path line segment
 static float previous_nominal_speed; // Nominal speed of previous path line segment
+#ifdef PREPLANNED_BLOCKS
+static bool last_block_preplanned;               // The newest block came from the host
+static float preplanned_exit_speed[NUM_AXIS];   // and its axis speeds at the end, mm/s
+#endif
+
+#ifdef POWER_LOSS_RESUME
+plan_resume_t plan_resume;
+#endif
 
 #ifdef AUTOTEMP
 float autotemp_max=250;
@@ -348,6 +356,9 @@ void planner_recalculate_trapezoids() {
     next = &block_buffer[block_index];
     if (current) {
       // Recalculate if current block entry or exit junction speed has changed.
+      #ifdef PREPLANNED_BLOCKS
+      if (current->preplanned) ; else
+      #endif
       if (current->recalculate_flag || next->recalculate_flag) {
         // NOTE: Entry and exit factors always > 0 by all previous logic operations.
         calculate_trapezoid_for_block(current, current->entry_speed/current->nominal_speed,
@@ -358,6 +369,9 @@ void planner_recalculate_trapezoids() {
     block_index = next_block_index( block_index );
   }
   // Last/newest block in buffer. Exit speed is set with MINIMUM_PLANNER_SPEED. Always recalculated.
+  #ifdef PREPLANNED_BLOCKS
+  if(next != NULL && next->preplanned) next = NULL;
+  #endif
   if(next != NULL) {
     calculate_trapezoid_for_block(next, next->entry_speed/next->nominal_speed,
     MINIMUM_PLANNER_SPEED/next->nominal_speed);
@@ -526,6 +540,46 @@ float junction_deviation = 0.1;
 // Add a new linear movement to the buffer. steps_x, _y and _z is the absolute position in 
 // mm. Microseconds specify how many microseconds the move should take to perform. To aid acceleration
 // calculation the caller must also provide the physical length of the line in millimeters.
+//enable active axes
+static void plan_enable_axes(block_t *block)
+{
+  #ifdef COREXY
+  if((block->steps_x != 0) || (block->steps_y != 0))
+  {
+    enable_x();
+    enable_y();
+  }
+  #else
+  if(block->steps_x != 0) enable_x();
+  if(block->steps_y != 0) enable_y();
+  #endif
+#ifndef Z_LATE_ENABLE
+  if(block->steps_z != 0) enable_z();
+#endif
+
+  // Enable all
+  if(block->steps_e != 0)
+  {
+    enable_e0();
+    enable_e1();
+    enable_e2(); 
+  }
+}
+
+#if USE_L6470 == 1
+// Every moving axis costs one SPI MOVE per interrupt.  Blocks that can run
+// within the SPI budget single step; faster ones may hand the L6470s several
+// steps per MOVE.
+static void plan_set_step_shift(block_t *block)
+{
+  block->max_isr_rate = st_l6470_max_isr_rate((block->steps_x != 0) + (block->steps_y != 0) +
+                                              (block->steps_z != 0) + (block->steps_e != 0));
+  block->step_shift = 0;
+  while (block->step_shift < L6470_MAX_STEP_SHIFT && (block->nominal_rate >> block->step_shift) > block->max_isr_rate)
+    block->step_shift++;
+}
+#endif
+
 #ifdef ENABLE_AUTO_BED_LEVELING
 void plan_buffer_line(float x, float y, float z, const float &e, float feed_rate, const uint8_t &extruder)
 #else
@@ -583,6 +637,12 @@ void plan_buffer_line(const float &x, const float &y, const float &z, const floa
 
   // Mark block as not busy (Not executed by the stepper interrupt)
   block->busy = false;
+  #ifdef PREPLANNED_BLOCKS
+  block->preplanned = false;
+  #endif
+  #ifdef POWER_LOSS_RESUME
+  block->resume = plan_resume;
+  #endif
 
   // Number of steps for each axis
 #ifndef COREXY
@@ -645,28 +705,7 @@ block->steps_y = labs((target[X_AXIS]-position[X_AXIS]) - (target[Y_AXIS]-positi
 
   block->active_extruder = extruder;
 
-  //enable active axes
-  #ifdef COREXY
-  if((block->steps_x != 0) || (block->steps_y != 0))
-  {
-    enable_x();
-    enable_y();
-  }
-  #else
-  if(block->steps_x != 0) enable_x();
-  if(block->steps_y != 0) enable_y();
-  #endif
-#ifndef Z_LATE_ENABLE
-  if(block->steps_z != 0) enable_z();
-#endif
-
-  // Enable all
-  if(block->steps_e != 0)
-  {
-    enable_e0();
-    enable_e1();
-    enable_e2(); 
-  }
+  plan_enable_axes(block);
 
   if (block->steps_e == 0)
   {
@@ -784,6 +823,10 @@ block->steps_y = labs((target[X_AXIS]-position[X_AXIS]) - (target[Y_AXIS]-positi
     block->nominal_rate *= speed_factor;
   }
 
+  #if USE_L6470 == 1
+    plan_set_step_shift(block);
+  #endif
+
   // Compute and limit the acceleration rate for the trapezoid generator.  
   float steps_per_mm = block->step_event_count/block->millimeters;
   if(block->steps_x == 0 && block->steps_y == 0 && block->steps_z == 0)
@@ -931,6 +974,9 @@ block->steps_y = labs((target[X_AXIS]-position[X_AXIS]) - (target[Y_AXIS]-positi
 
   // Move buffer head
   block_buffer_head = next_buffer_head;
+  #ifdef PREPLANNED_BLOCKS
+  last_block_preplanned = false;
+  #endif
 
   // Update position
   memcpy(position, target, sizeof(target)); // position[] = target[]
@@ -940,6 +986,134 @@ block->steps_y = labs((target[X_AXIS]-position[X_AXIS]) - (target[Y_AXIS]-positi
   st_wake_up();
 }
 
+#ifdef PREPLANNED_BLOCKS
+static bool plan_reject_block(const char *reason)
+{
+  SERIAL_ERROR_START;
+  SERIAL_ERRORPGM(MSG_BLOCK_REFUSED);
+  serialprintPGM(reason);
+  SERIAL_PROTOCOLLNPGM("");
+  return false;
+}
+
+bool plan_buffer_block(const preplanned_block_t &pb, const uint8_t &extruder)
+{
+  int next_buffer_head = next_block_index(block_buffer_head);
+  while(block_buffer_tail == next_buffer_head)
+  {
+    manage_heater(); 
+    manage_inactivity(); 
+    lcd_update();
+  }
+
+  unsigned long steps[NUM_AXIS];
+  unsigned long step_event_count = 0;
+  for(int8_t i=0; i < NUM_AXIS; i++) {
+    steps[i] = labs(pb.steps[i]);
+    step_event_count = max(step_event_count, steps[i]);
+  }
+  if(step_event_count == 0 || pb.accelerate_until > pb.decelerate_after || pb.decelerate_after > step_event_count)
+    return plan_reject_block(PSTR(MSG_BLOCK_STEP_COUNTS));
+  if(pb.initial_rate < 120 || pb.final_rate < 120 || pb.initial_rate > pb.nominal_rate || pb.final_rate > pb.nominal_rate)
+    return plan_reject_block(PSTR(MSG_BLOCK_RATES));
+
+  #ifdef PREVENT_DANGEROUS_EXTRUDE
+  if(steps[E_AXIS] != 0 && degHotend(extruder) < extrude_min_temp)
+    return plan_reject_block(PSTR(MSG_ERR_COLD_EXTRUDE_STOP));
+  #ifdef PREVENT_LENGTHY_EXTRUDE
+  if(steps[E_AXIS] > axis_steps_per_unit[E_AXIS]*EXTRUDE_MAXLENGTH)
+    return plan_reject_block(PSTR(MSG_ERR_LONG_EXTRUDE_STOP));
+  #endif
+  #endif
+
+  // The same per axis speed and acceleration limits as for planned moves, and the jerk at
+  // the junction with the previous host block, or from standstill as for a planned move
+  bool from_rest = !(last_block_preplanned && blocks_queued());
+  float jerk_scale = from_rest ? 0.5 : 1.0;
+  float entry_jerk[NUM_AXIS], exit_speed[NUM_AXIS];
+  for(int8_t i=0; i < NUM_AXIS; i++) {
+    float fraction = (float)steps[i] / (float)step_event_count;
+    if(pb.nominal_rate * fraction > max_feedrate[i] * axis_steps_per_unit[i])
+      return plan_reject_block(PSTR(MSG_BLOCK_FEEDRATE));
+    if(pb.acceleration_st * fraction > axis_steps_per_sqr_second[i])
+      return plan_reject_block(PSTR(MSG_BLOCK_ACCELERATION));
+    float mm_per_event = fraction / axis_steps_per_unit[i];
+    if(pb.steps[i] < 0) mm_per_event = -mm_per_event;
+    entry_jerk[i] = pb.initial_rate * mm_per_event - (from_rest ? 0.0 : preplanned_exit_speed[i]);
+    exit_speed[i] = pb.final_rate * mm_per_event;
+  }
+  if(square(entry_jerk[X_AXIS]) + square(entry_jerk[Y_AXIS]) > square(max_xy_jerk * jerk_scale) ||
+     fabs(entry_jerk[Z_AXIS]) > max_z_jerk * jerk_scale || fabs(entry_jerk[E_AXIS]) > max_e_jerk * jerk_scale)
+    return plan_reject_block(PSTR(MSG_BLOCK_JERK));
+
+  // Whatever speed the acceleration reaches must come down to final_rate within the block
+  float twice_accel = 2.0 * pb.acceleration_st;
+  float peak_rate_sq = min(square((float)pb.nominal_rate),
+                           square((float)pb.initial_rate) + twice_accel * pb.accelerate_until);
+  if(peak_rate_sq - square((float)pb.final_rate) > twice_accel * (step_event_count - pb.decelerate_after + 1))
+    return plan_reject_block(PSTR(MSG_BLOCK_DECELERATION));
+
+  block_t *block = &block_buffer[block_buffer_head];
+  block->busy = false;
+  block->steps_x = steps[X_AXIS];
+  block->steps_y = steps[Y_AXIS];
+  block->steps_z = steps[Z_AXIS];
+  block->steps_e = steps[E_AXIS];
+  block->step_event_count = step_event_count;
+  block->accelerate_until = pb.accelerate_until;
+  block->decelerate_after = pb.decelerate_after;
+  block->initial_rate = pb.initial_rate;
+  block->nominal_rate = pb.nominal_rate;
+  block->final_rate = pb.final_rate;
+  block->acceleration_st = pb.acceleration_st;
+  block->acceleration_rate = (long)((float)block->acceleration_st * (16777216.0 / (F_CPU / 8.0)));
+  block->direction_bits = 0;
+  for(int8_t i=0; i < NUM_AXIS; i++)
+    if(pb.steps[i] < 0) block->direction_bits |= (1<<i);
+  block->active_extruder = extruder;
+  block->fan_speed = fanSpeed;
+  #ifdef BARICUDA
+  block->valve_pressure = ValvePressure;
+  block->e_to_p_pressure = EtoPPressure;
+  #endif
+  #if USE_L6470 == 1
+    plan_set_step_shift(block);
+  #endif
+  #ifdef ADVANCE
+    block->advance_rate = 0;
+    block->advance = 0;
+    block->initial_advance = 0;
+    block->final_advance = 0;
+  #endif
+
+  // A zero entry speed makes the planner end the move before it at the minimum speed
+  // and never plan across this block
+  block->preplanned = true;
+  #ifdef POWER_LOSS_RESUME
+  block->resume = plan_resume;
+  #endif
+  block->nominal_speed = 0.0;
+  block->entry_speed = 0.0;
+  block->max_entry_speed = 0.0;
+  block->millimeters = 0.0;
+  block->acceleration = 0.0;
+  block->nominal_length_flag = true;
+  block->recalculate_flag = false;
+
+  plan_enable_axes(block);
+
+  block_buffer_head = next_buffer_head;
+  for(int8_t i=0; i < NUM_AXIS; i++)
+    position[i] += pb.steps[i];
+  previous_nominal_speed = 0.0; // the next planned move starts from the safe speed
+  memcpy(preplanned_exit_speed, exit_speed, sizeof(exit_speed));
+  last_block_preplanned = true;
+
+  st_wake_up();
+  return true;
+}
+#endif // PREPLANNED_BLOCKS
+
 #ifdef ENABLE_AUTO_BED_LEVELING
 vector_3 plan_get_position() {
 	vector_3 position = vector_3(st_get_position_mm(X_AXIS), st_get_position_mm(Y_AXIS), st_get_position_mm(Z_AXIS));
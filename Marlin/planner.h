@@ -30,6 +30,23 @@
 #include "vector_3.h"
 #endif // ENABLE_AUTO_BED_LEVELING
 
+#ifdef POWER_LOSS_RESUME
+// Where an SD command leaves the print, for the power loss journal: the file offset
+// behind it and the modal state as the commands up to there have set it
+typedef struct {
+  unsigned long sdpos;                // 0 if the command is not from SD
+  float feedrate;                     // mm/min
+  int target_temperature[EXTRUDERS];
+  int target_temperature_bed;
+  unsigned char fan_speed;
+  unsigned char extruder;             // active_extruder
+  unsigned char flags;                // PLR_RELATIVE_*
+} plan_resume_t;
+
+#define PLR_RELATIVE_XYZ  1           // G91
+#define PLR_RELATIVE_E    2           // M83
+#endif
+
 // This struct is used when buffering the setup for each linear movement "nominal" values are as specified in 
 // the source g-code and may never actually be reached if acceleration management is active.
 typedef struct {
@@ -41,6 +58,10 @@ typedef struct {
   long acceleration_rate;                   // The acceleration rate used for acceleration calculation
   unsigned char direction_bits;             // The direction bit set for this block (refers to *_DIRECTION_BIT in config.h)
   unsigned char active_extruder;            // Selects the active extruder
+  #if defined(USE_L6470) && (USE_L6470 != 0)
+    unsigned char step_shift;               // At most 1 << step_shift steps per stepper interrupt
+    unsigned short max_isr_rate;            // Interrupt rate at which SPI use reaches L6470_SPI_BUDGET
+  #endif
   #ifdef ADVANCE
     long advance_rate;
     volatile long initial_advance;
@@ -57,6 +78,12 @@ typedef struct {
   float acceleration;                                // acceleration mm/sec^2
   unsigned char recalculate_flag;                    // Planner flag to recalculate trapezoids on entry junction
   unsigned char nominal_length_flag;                 // Planner flag for nominal speed always reached
+  #ifdef PREPLANNED_BLOCKS
+  unsigned char preplanned;                          // Planned by the host: the trapezoid is never recalculated
+  #endif
+  #ifdef POWER_LOSS_RESUME
+  plan_resume_t resume;                              // of the command that made the block
+  #endif
 
   // Settings for the trapezoid generator
   unsigned long nominal_rate;                        // The nominal step rate for this block in step_events/sec 
@@ -100,6 +127,31 @@ void plan_set_position(const float &x, const float &y, const float &z, const flo
 
 void plan_set_e_position(const float &e);
 
+#ifdef PREPLANNED_BLOCKS
+#ifndef BINARY_PROTOCOL
+  #error PREPLANNED_BLOCKS needs BINARY_PROTOCOL
+#endif
+#if defined(COREXY) || defined(DELTA)
+  #error PREPLANNED_BLOCKS is only implemented for cartesian machines
+#endif
+// A block planned by the host in machine coordinates, so with ENABLE_AUTO_BED_LEVELING the
+// host applies the bed level correction: signed steps per axis, the step events at which acceleration
+// ends and deceleration starts, rates in steps/sec and acceleration in steps/sec^2
+typedef struct {
+  long steps[NUM_AXIS];
+  unsigned long accelerate_until;
+  unsigned long decelerate_after;
+  unsigned long initial_rate;
+  unsigned long nominal_rate;
+  unsigned long final_rate;
+  unsigned long acceleration_st;
+} preplanned_block_t;
+
+// Check a host-planned block against the speed, acceleration, jerk and extrusion limits
+// and queue it as it is.  Returns false, after reporting why, if it is refused.
+bool plan_buffer_block(const preplanned_block_t &pb, const uint8_t &extruder);
+#endif
+
 
 
 void check_axes_activity();
@@ -117,6 +169,9 @@ extern float max_z_jerk;
 extern float max_e_jerk;
 extern float mintravelfeedrate;
 extern unsigned long axis_steps_per_sqr_second[NUM_AXIS];
+#ifdef POWER_LOSS_RESUME
+extern plan_resume_t plan_resume;  // of the command being planned
+#endif
 
 #ifdef AUTOTEMP
     extern bool autotemp_enabled;
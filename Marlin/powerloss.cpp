@@ -0,0 +1,148 @@
+#include "Marlin.h"
+#include "cardreader.h"
+#include "powerloss.h"
+#include "ConfigurationStore.h"
+
+#ifdef POWER_LOSS_RESUME
+
+#include <util/crc16.h>
+
+// The journal takes the top PLR_EEPROM_SIZE bytes of the EEPROM: the number of the
+// current print, its file name, then as many record slots as fit.  Records go round
+// robin through the slots, so the last one written stays intact while the next is
+// written, and a record counts only if its CRC is good and its key is the CRC of the
+// print number and file name.  Starting or ending a print changes the number first,
+// which retires every record of the previous one.
+#define PLR_ID     ((uint8_t *)(E2END + 1 - PLR_EEPROM_SIZE))
+#define PLR_NAME   (PLR_ID + 1)
+#define PLR_SLOT0  (PLR_NAME + MAXPATHNAMELENGTH)
+#define PLR_SLOTS  ((PLR_EEPROM_SIZE - 1 - MAXPATHNAMELENGTH) / sizeof(plr_record_t))
+#define PLR_SLOT(i) (PLR_SLOT0 + (i) * sizeof(plr_record_t))
+
+#if PLR_EEPROM_SIZE < 512
+  #error PLR_EEPROM_SIZE is too small for the file name and a few records
+#endif
+#if E2END + 1 < EEPROM_SETTINGS_END + PLR_EEPROM_SIZE
+  #error PLR_EEPROM_SIZE does not fit in the EEPROM above the settings
+#endif
+
+static bool plr_ready = false;
+static uint16_t plr_key;      // of the current print
+static uint8_t plr_slot;      // holding the latest record
+static uint16_t plr_seq;      // of the latest record
+static plr_record_t plr_pending;
+static uint8_t *plr_pending_src, *plr_pending_dst;
+static uint8_t plr_pending_left = 0;
+
+static uint16_t plr_crc(const uint8_t *p, uint8_t n)
+{
+  uint16_t crc = 0;
+  while(n--)
+    crc = _crc_xmodem_update(crc, *p++);
+  return crc;
+}
+
+// Find the latest good record of any print, to carry on the slots and numbering
+static void plr_init()
+{
+  uint16_t key = _crc_xmodem_update(0, eeprom_read_byte(PLR_ID));
+  for(uint8_t i = 0; i < MAXPATHNAMELENGTH; i++) {
+    uint8_t c = eeprom_read_byte(PLR_NAME + i);
+    if(!c) break;
+    key = _crc_xmodem_update(key, c);
+  }
+  plr_key = key;
+
+  bool found = false;
+  plr_slot = PLR_SLOTS - 1;
+  plr_seq = 0;
+  for(uint8_t i = 0; i < PLR_SLOTS; i++) {
+    plr_record_t rec;
+    eeprom_read_block(&rec, PLR_SLOT(i), sizeof(rec));
+    if(rec.crc != plr_crc((uint8_t *)&rec, offsetof(plr_record_t, crc)))
+      continue;
+    if(!found || (int16_t)(rec.seq - plr_seq) > 0) {
+      found = true;
+      plr_slot = i;
+      plr_seq = rec.seq;
+    }
+  }
+  plr_ready = true;
+}
+
+static void plr_next_print()
+{
+  plr_pending_left = 0;
+  eeprom_write_byte(PLR_ID, eeprom_read_byte(PLR_ID) + 1);
+}
+
+void plr_start(const char *name, bool restart)
+{
+  uint8_t len = strlen(name) + 1;
+  if(len > MAXPATHNAMELENGTH)
+    len = MAXPATHNAMELENGTH;
+  if(!restart) {
+    for(uint8_t i = 0; i < len && !restart; i++)
+      restart = (eeprom_read_byte(PLR_NAME + i) != (uint8_t)name[i]);
+  }
+  if(restart) {
+    plr_next_print();
+    eeprom_update_block(name, PLR_NAME, len);
+  }
+  plr_init();
+}
+
+void plr_finish()
+{
+  plr_next_print();
+  plr_init();
+}
+
+bool plr_busy()
+{
+  return plr_pending_left != 0;
+}
+
+void plr_write(plr_record_t &rec)
+{
+  if(plr_busy())
+    return;
+  if(!plr_ready)
+    plr_init();
+  plr_slot = (plr_slot + 1) % PLR_SLOTS;
+  rec.seq = ++plr_seq;
+  rec.key = plr_key;
+  rec.crc = plr_crc((uint8_t *)&rec, offsetof(plr_record_t, crc));
+  plr_pending = rec;
+  plr_pending_src = (uint8_t *)&plr_pending;
+  plr_pending_dst = PLR_SLOT(plr_slot);
+  plr_pending_left = sizeof(plr_pending);
+}
+
+// An EEPROM write takes 3.4ms: start one and come back when it is done, skipping the
+// bytes that are already right
+void plr_idle()
+{
+  while(plr_pending_left && eeprom_is_ready()) {
+    uint8_t b = *plr_pending_src++;
+    if(eeprom_read_byte(plr_pending_dst) != b)
+      eeprom_write_byte(plr_pending_dst, b);
+    plr_pending_dst++;
+    plr_pending_left--;
+  }
+}
+
+bool plr_load(plr_record_t &rec, char *name)
+{
+  if(!plr_ready)
+    plr_init();
+  // The latest record is in plr_slot unless it belongs to an earlier print
+  eeprom_read_block(&rec, PLR_SLOT(plr_slot), sizeof(rec));
+  if(rec.crc != plr_crc((uint8_t *)&rec, offsetof(plr_record_t, crc)) || rec.key != plr_key)
+    return false;
+  eeprom_read_block(name, PLR_NAME, MAXPATHNAMELENGTH);
+  name[MAXPATHNAMELENGTH - 1] = 0;
+  return name[0] != 0;
+}
+
+#endif // POWER_LOSS_RESUME
@@ -0,0 +1,35 @@
+#ifndef POWERLOSS_H
+#define POWERLOSS_H
+
+#include "Marlin.h"
+#include "planner.h"
+
+#ifdef POWER_LOSS_RESUME
+
+// What an SD print needs to continue after a power loss
+typedef struct {
+  uint16_t seq;                        // counts up from record to record
+  uint16_t key;                        // the print the record belongs to
+  plan_resume_t resume;                // of the last command whose moves are done
+  long steps[NUM_AXIS];                // where those moves left the steppers
+  #ifdef ENABLE_AUTO_BED_LEVELING
+  float bed_level[9];                  // plan_bed_level_matrix
+  #endif
+  uint16_t crc;
+} plr_record_t;
+
+// A print of the file name (an absolute path) starts, or continues if restart is false
+void plr_start(const char *name, bool restart);
+// The print ended; there is nothing to resume
+void plr_finish();
+// Journal a record; the call is ignored while the last one is still being written
+void plr_write(plr_record_t &rec);
+bool plr_busy();
+// Write some of the pending record; call from the main loop
+void plr_idle();
+// The latest record of the print in the journal and the file it is for
+bool plr_load(plr_record_t &rec, char *name);
+
+#endif // POWER_LOSS_RESUME
+
+#endif // POWERLOSS_H
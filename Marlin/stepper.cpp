@@ -51,6 +51,7 @@ block_t *current_block;  // A pointer to the block currently being traced
 
 // Variables used by The Stepper Driver Interrupt
 static unsigned char out_bits;        // The next stepping-bits to be output
+static unsigned char block_axes;      // Axes that take steps in the current block
 static long counter_x,       // Counter variables for the bresenham line tracer
             counter_y,
             counter_z,
@@ -325,14 +326,26 @@ void init_L6470_drivers()
   #if defined(X_L6470_CS_PIN) && (X_L6470_CS_PIN > -1)
 	init_6470(l6470_x, X_L6470_USTEPS, (float)X_L6470_MAX_SPD, (float)X_L6470_FS_SPD,
 			  X_L6470_KRUN, l6470_khold[0]);
+    #if defined(X_L6470_STCK_PIN) && (X_L6470_STCK_PIN > -1)
+      SET_OUTPUT(X_L6470_STCK_PIN);
+      WRITE(X_L6470_STCK_PIN, LOW);
+    #endif
   #endif
   #if defined(Y_L6470_CS_PIN) && (Y_L6470_CS_PIN > -1)
 	init_6470(l6470_y, Y_L6470_USTEPS, (float)Y_L6470_MAX_SPD, (float)Y_L6470_FS_SPD,
 			  Y_L6470_KRUN, l6470_khold[1]);
+    #if defined(Y_L6470_STCK_PIN) && (Y_L6470_STCK_PIN > -1)
+      SET_OUTPUT(Y_L6470_STCK_PIN);
+      WRITE(Y_L6470_STCK_PIN, LOW);
+    #endif
   #endif
   #if defined(Z_L6470_CS_PIN) && (Z_L6470_CS_PIN > -1)
 	init_6470(l6470_z, Z_L6470_USTEPS, (float)Z_L6470_MAX_SPD, (float)Z_L6470_FS_SPD,
 			  Z_L6470_KRUN, l6470_khold[2]);
+    #if defined(Z_L6470_STCK_PIN) && (Z_L6470_STCK_PIN > -1)
+      SET_OUTPUT(Z_L6470_STCK_PIN);
+      WRITE(Z_L6470_STCK_PIN, LOW);
+    #endif
 	// l6470_z.setParam(L6470_MIN_SPEED, 0x0FFF);
 	// l6470_z.setLSPDOpt(true);
   #endif
@@ -350,6 +363,285 @@ void init_L6470_drivers()
   #endif
 }
 
+// Time one SPI MOVE takes, in timer 1 ticks (0.5us); measured by st_init()
+static unsigned short l6470_move_ticks = 40;
+
+// Time a busy check plus a 4 byte transfer (the size of a MOVE).  Must run
+// before the stepper interrupt is enabled.
+static void l6470_measure_spi()
+{
+  L6470 *l = NULL;
+  uint8_t bsy_pin = 0;
+  #if defined(X_L6470_CS_PIN) && (X_L6470_CS_PIN > -1)
+    l = &l6470_x; bsy_pin = X_L6470_BSY_PIN;
+  #elif defined(Y_L6470_CS_PIN) && (Y_L6470_CS_PIN > -1)
+    l = &l6470_y; bsy_pin = Y_L6470_BSY_PIN;
+  #endif
+  if (l == NULL) return;
+  unsigned long start = micros();
+  for (uint8_t i = 0; i < 16; i++) {
+    digitalRead(bsy_pin);
+    l->getParam(L6470_ABS_POS);
+  }
+  // 16 transfers, 2 ticks per us
+  l6470_move_ticks = (micros() - start) / 8;
+  if (l6470_move_ticks == 0) l6470_move_ticks = 1;
+}
+
+unsigned short st_l6470_max_isr_rate(uint8_t axes)
+{
+  if (axes == 0) axes = 1;
+  unsigned long rate = (2000000UL / 100 * L6470_SPI_BUDGET) / ((unsigned long)l6470_move_ticks * axes);
+  return rate > 0xFFFF ? 0xFFFF : rate;
+}
+
+#ifdef L6470_STEP_VERIFY
+
+// Closed-loop step verification
+//
+// The stepper ISR hands each L6470 a MOVE and never learns whether the driver
+// performed it: a MOVE that arrives while the driver is still BUSY is dropped
+// (NOTPERF_CMD).  ABS_POS counts the microsteps the driver really issued, so
+// comparing it against count_position[] shows any steps that went missing.
+// This runs from the main loop; each read is done with interrupts off so the
+// SPI transfer cannot interleave with a MOVE sent by the stepper ISR.
+
+bool l6470_verify_enabled = true;
+unsigned long l6470_verify_interval = L6470_VERIFY_INTERVAL;
+long l6470_verify_tolerance = L6470_VERIFY_TOLERANCE;
+uint8_t l6470_verify_action = L6470_VERIFY_ACTION;
+long l6470_drift[3] = { 0, 0, 0 };  // last measured drift, driver microsteps
+
+static long l6470_verify_offset[3];     // ABS_POS minus expected position at the last resync
+static long l6470_drift_reported[3];    // drift at the time it was last reported
+static bool l6470_verify_synced = false;
+static unsigned long l6470_verify_next = 0;
+
+void st_l6470_verify_resync()
+{
+  l6470_verify_synced = false;
+}
+
+// Drift of one axis in driver microsteps: where ABS_POS says the motor is,
+// minus where count_position[] says it should be.
+static long l6470_axis_drift(L6470 &l, uint8_t axis, long nsteps, bool invert_dir)
+{
+  long abs_pos, count;
+  CRITICAL_SECTION_START;
+  abs_pos = (long)l.getParam(L6470_ABS_POS);
+  count = count_position[axis];
+  CRITICAL_SECTION_END;
+  if (abs_pos & 0x200000L) abs_pos -= 0x400000L;  // ABS_POS is 22 bit two's complement
+
+  // Stepping towards negative counts drives the L6470 FWD unless the axis is inverted
+  long drift = abs_pos - (invert_dir ? count * nsteps : -count * nsteps);
+  if (!l6470_verify_synced) l6470_verify_offset[axis] = drift;
+  drift -= l6470_verify_offset[axis];
+
+  // ABS_POS wraps, so fold the difference back into the 22 bit range
+  return ((drift + 0x200000L) & 0x3FFFFFL) - 0x200000L;
+}
+
+void st_l6470_verify_report()
+{
+  SERIAL_ECHO_START;
+  SERIAL_ECHOPGM("L6470 drift (microsteps) X:");
+  SERIAL_ECHO(l6470_drift[X_AXIS]);
+  SERIAL_ECHOPGM(" Y:");
+  SERIAL_ECHO(l6470_drift[Y_AXIS]);
+  SERIAL_ECHOPGM(" Z:");
+  SERIAL_ECHO(l6470_drift[Z_AXIS]);
+  SERIAL_ECHOLN("");
+}
+
+void st_l6470_verify()
+{
+  if (!l6470_verify_enabled || l6470_verify_interval == 0) return;
+  if ((long)(millis() - l6470_verify_next) < 0) return;
+  l6470_verify_next = millis() + l6470_verify_interval;
+
+  #if defined(X_L6470_CS_PIN) && (X_L6470_CS_PIN > -1)
+    l6470_drift[X_AXIS] = l6470_axis_drift(l6470_x, X_AXIS, X_L6470_NSTEPS, INVERT_X_DIR);
+  #endif
+  #if defined(Y_L6470_CS_PIN) && (Y_L6470_CS_PIN > -1)
+    l6470_drift[Y_AXIS] = l6470_axis_drift(l6470_y, Y_AXIS, Y_L6470_NSTEPS, INVERT_Y_DIR);
+  #endif
+  #if defined(Z_L6470_CS_PIN) && (Z_L6470_CS_PIN > -1)
+    l6470_drift[Z_AXIS] = l6470_axis_drift(l6470_z, Z_AXIS, Z_L6470_NSTEPS, INVERT_Z_DIR);
+  #endif
+  if (!l6470_verify_synced) {
+    l6470_verify_synced = true;
+    for (uint8_t axis = X_AXIS; axis <= Z_AXIS; axis++) l6470_drift_reported[axis] = 0;
+    return;
+  }
+
+  // Only report a drift once, and again if it grows by another tolerance's worth
+  bool slipped = false, slipped_xy = false;
+  for (uint8_t axis = X_AXIS; axis <= Z_AXIS; axis++) {
+    if (labs(l6470_drift[axis] - l6470_drift_reported[axis]) <= l6470_verify_tolerance) continue;
+    l6470_drift_reported[axis] = l6470_drift[axis];
+    if (labs(l6470_drift[axis]) <= l6470_verify_tolerance) continue;
+    slipped = true;
+    if (axis != Z_AXIS) slipped_xy = true;
+  }
+  if (!slipped) return;
+
+  st_l6470_verify_report();
+  if (l6470_verify_action >= 1) {
+    #ifdef SDSUPPORT
+      if (card.sdprinting) card.pauseSDPrint();
+    #endif
+  }
+  if (l6470_verify_action >= 2 && slipped_xy) {
+    // Homing calls st_set_position(), which resyncs the check
+    enquecommand_P(PSTR("G28 X Y"));
+  }
+}
+
+#endif // L6470_STEP_VERIFY
+
+#ifdef L6470_HEALTH_MONITOR
+
+// Driver health monitor
+//
+// The STATUS register latches undervoltage, thermal, overcurrent and stall
+// conditions until it is read, so polling it at a low rate still catches
+// every event.  Reading STATUS also clears the latched flags.
+
+unsigned long l6470_health_interval = L6470_HEALTH_INTERVAL;
+uint8_t l6470_health_action = L6470_HEALTH_ACTION;
+l6470_health_t l6470_health[4];  // X, Y, Z, E0 like l6470_khold[]
+
+static unsigned long l6470_health_next = 0;
+
+// STATUS bit for each L6470_EV_* index
+static const uint16_t l6470_event_bit[L6470_EVENTS] PROGMEM = {
+  L6470_STATUS_UVLO, L6470_STATUS_TH_WRN, L6470_STATUS_TH_SD, L6470_STATUS_OCD,
+  L6470_STATUS_STEP_LOSS_A, L6470_STATUS_STEP_LOSS_B, L6470_STATUS_NOTPERF_CMD, L6470_STATUS_WRONG_CMD
+};
+
+// These flags are active low in STATUS
+#define L6470_STATUS_ACTIVE_LOW (L6470_STATUS_UVLO | L6470_STATUS_TH_WRN | L6470_STATUS_TH_SD | \
+                                 L6470_STATUS_OCD | L6470_STATUS_STEP_LOSS_A | L6470_STATUS_STEP_LOSS_B)
+
+static L6470 *l6470_driver(uint8_t i)
+{
+  switch(i) {
+  #if defined(X_L6470_CS_PIN) && (X_L6470_CS_PIN > -1)
+    case 0: return &l6470_x;
+  #endif
+  #if defined(Y_L6470_CS_PIN) && (Y_L6470_CS_PIN > -1)
+    case 1: return &l6470_y;
+  #endif
+  #if defined(Z_L6470_CS_PIN) && (Z_L6470_CS_PIN > -1)
+    case 2: return &l6470_z;
+  #endif
+  #if defined(E0_L6470_CS_PIN) && (E0_L6470_CS_PIN > -1)
+    case 3: return &l6470_e0;
+  #endif
+  }
+  return NULL;
+}
+
+static void l6470_echo_event_name(uint8_t ev)
+{
+  switch(ev) {
+    case L6470_EV_UVLO:      SERIAL_ECHOPGM("UVLO"); break;
+    case L6470_EV_TH_WRN:    SERIAL_ECHOPGM("TH_WRN"); break;
+    case L6470_EV_TH_SD:     SERIAL_ECHOPGM("TH_SD"); break;
+    case L6470_EV_OCD:       SERIAL_ECHOPGM("OCD"); break;
+    case L6470_EV_STALL_A:   SERIAL_ECHOPGM("STALL_A"); break;
+    case L6470_EV_STALL_B:   SERIAL_ECHOPGM("STALL_B"); break;
+    case L6470_EV_NOTPERF:   SERIAL_ECHOPGM("NOTPERF"); break;
+    case L6470_EV_WRONG_CMD: SERIAL_ECHOPGM("WRONG_CMD"); break;
+  }
+}
+
+void st_l6470_health_reset()
+{
+  memset(l6470_health, 0, sizeof(l6470_health));
+}
+
+void st_l6470_health()
+{
+  if (l6470_health_interval == 0) return;
+  if ((long)(millis() - l6470_health_next) < 0) return;
+  unsigned long now = millis();
+  l6470_health_next = now + l6470_health_interval;
+
+  // NOTPERF/WRONG_CMD are only counted: a MOVE refused while BUSY is already
+  // covered by step verification and would flood the log at high speed.
+  bool warn = false, fault = false;
+  for (uint8_t i = 0; i < 4; i++) {
+    L6470 *l = l6470_driver(i);
+    if (l == NULL) continue;
+    uint16_t status;
+    CRITICAL_SECTION_START;
+    status = l->getStatus();
+    CRITICAL_SECTION_END;
+    l6470_health[i].status = status;
+    uint16_t active = (status ^ L6470_STATUS_ACTIVE_LOW) &
+                      (L6470_STATUS_ACTIVE_LOW | L6470_STATUS_NOTPERF_CMD | L6470_STATUS_WRONG_CMD);
+    if (!active) continue;
+
+    bool logged = false;
+    for (uint8_t ev = 0; ev < L6470_EVENTS; ev++) {
+      if (!(active & pgm_read_word(&l6470_event_bit[ev]))) continue;
+      if (l6470_health[i].count[ev] < 0xFFFF) l6470_health[i].count[ev]++;
+      l6470_health[i].last_ms[ev] = now;
+      if (ev >= L6470_EV_NOTPERF) continue;
+      if (!logged) {
+        SERIAL_ECHO_START;
+        SERIAL_ECHOPGM("L6470 ");
+        SERIAL_ECHO("XYZE"[i]);
+        SERIAL_ECHOPGM(":");
+        logged = true;
+      }
+      SERIAL_ECHOPGM(" ");
+      l6470_echo_event_name(ev);
+      if (ev == L6470_EV_TH_WRN || ev == L6470_EV_STALL_A || ev == L6470_EV_STALL_B) warn = true;
+      else fault = true;
+    }
+    if (logged) SERIAL_ECHOLN("");
+  }
+
+  if (l6470_health_action >= 1 && (warn || fault) && feedmultiply > L6470_HEALTH_SLOWDOWN)
+    feedmultiply = L6470_HEALTH_SLOWDOWN;
+  if (l6470_health_action >= 2 && fault) {
+    #ifdef SDSUPPORT
+      if (card.sdprinting) card.pauseSDPrint();
+    #endif
+  }
+}
+
+void st_l6470_health_report()
+{
+  unsigned long now = millis();
+  for (uint8_t i = 0; i < 4; i++) {
+    if (l6470_driver(i) == NULL) continue;
+    SERIAL_ECHO_START;
+    SERIAL_ECHOPGM("L6470 ");
+    SERIAL_ECHO("XYZE"[i]);
+    SERIAL_ECHOPGM(" STATUS:");
+    SERIAL_PROTOCOL_F(l6470_health[i].status, HEX);
+    for (uint8_t ev = 0; ev < L6470_EVENTS; ev++) {
+      SERIAL_ECHOPGM(" ");
+      l6470_echo_event_name(ev);
+      SERIAL_ECHOPGM(":");
+      SERIAL_ECHO(l6470_health[i].count[ev]);
+      if (l6470_health[i].count[ev]) {
+        // seconds since the most recent event
+        SERIAL_ECHOPGM("/");
+        SERIAL_ECHO((now - l6470_health[i].last_ms[ev]) / 1000);
+        SERIAL_ECHOPGM("s");
+      }
+    }
+    SERIAL_ECHOLN("");
+  }
+}
+
+#endif // L6470_HEALTH_MONITOR
+
 #endif
 
 // Some useful constants
@@ -405,6 +697,158 @@ void enable_endstops(bool check)
   check_endstops = check;
 }
 
+#ifdef ENDSTOP_INTERRUPTS
+// Endstops on pins with an interrupt.  The pin interrupt latches the position
+// the moment the switch closes; the stepper ISR ends the block if the switch still
+// reads closed at its next interrupt, which is the two samples the polled endstops
+// take, so a spike on the wire does not stop the move.
+// Like the polled endstops, a switch only counts while the axis moves towards it.
+
+static volatile uint8_t endstop_latched = 0;  // axes whose switch closed
+
+FORCE_INLINE void endstop_latch(const uint8_t axis)
+{
+  endstops_trigsteps[axis] = count_position[axis];
+  endstop_latched |= (1 << axis);
+}
+
+#ifdef X_ENDSTOP_INTERRUPT
+FORCE_INLINE bool x_endstop_active()
+{
+  if ((current_block->direction_bits & (1<<X_AXIS)) != 0) {
+    #if defined(X_MIN_PIN) && X_MIN_PIN > -1
+      return READ(X_MIN_PIN) != X_MIN_ENDSTOP_INVERTING;
+    #endif
+  }
+  else {
+    #if defined(X_MAX_PIN) && X_MAX_PIN > -1
+      return READ(X_MAX_PIN) != X_MAX_ENDSTOP_INVERTING;
+    #endif
+  }
+  return false;
+}
+#endif
+
+#ifdef Y_ENDSTOP_INTERRUPT
+FORCE_INLINE bool y_endstop_active()
+{
+  if ((current_block->direction_bits & (1<<Y_AXIS)) != 0) {
+    #if defined(Y_MIN_PIN) && Y_MIN_PIN > -1
+      return READ(Y_MIN_PIN) != Y_MIN_ENDSTOP_INVERTING;
+    #endif
+  }
+  else {
+    #if defined(Y_MAX_PIN) && Y_MAX_PIN > -1
+      return READ(Y_MAX_PIN) != Y_MAX_ENDSTOP_INVERTING;
+    #endif
+  }
+  return false;
+}
+#endif
+
+#ifdef Z_ENDSTOP_INTERRUPT
+FORCE_INLINE bool z_endstop_active()
+{
+  if ((current_block->direction_bits & (1<<Z_AXIS)) != 0) {
+    #if defined(Z_MIN_PIN) && Z_MIN_PIN > -1
+      return READ(Z_MIN_PIN) != Z_MIN_ENDSTOP_INVERTING;
+    #endif
+  }
+  else {
+    #if defined(Z_MAX_PIN) && Z_MAX_PIN > -1
+      return READ(Z_MAX_PIN) != Z_MAX_ENDSTOP_INVERTING;
+    #endif
+  }
+  return false;
+}
+#endif
+
+// Check every interrupt driven endstop of the current block
+FORCE_INLINE void endstops_check_latched()
+{
+  if (!check_endstops || current_block == NULL || endstop_latched) return;
+  #ifdef X_ENDSTOP_INTERRUPT
+    if (current_block->steps_x > 0 && x_endstop_active()) endstop_latch(X_AXIS);
+  #endif
+  #ifdef Y_ENDSTOP_INTERRUPT
+    if (current_block->steps_y > 0 && y_endstop_active()) endstop_latch(Y_AXIS);
+  #endif
+  #ifdef Z_ENDSTOP_INTERRUPT
+    if (current_block->steps_z > 0 && z_endstop_active()) endstop_latch(Z_AXIS);
+  #endif
+}
+
+// Second sample of the latched switches, from the stepper ISR: true if one is still
+// closed.  The others are let go, so their pins can latch again.
+FORCE_INLINE bool endstops_confirm_latched()
+{
+  uint8_t latched = endstop_latched;
+  bool hit = false;
+  #ifdef X_ENDSTOP_INTERRUPT
+    if ((latched & (1<<X_AXIS)) && x_endstop_active()) hit = endstop_x_hit = true;
+  #endif
+  #ifdef Y_ENDSTOP_INTERRUPT
+    if ((latched & (1<<Y_AXIS)) && y_endstop_active()) hit = endstop_y_hit = true;
+  #endif
+  #ifdef Z_ENDSTOP_INTERRUPT
+    if ((latched & (1<<Z_AXIS)) && z_endstop_active()) hit = endstop_z_hit = true;
+  #endif
+  endstop_latched = 0;
+  return hit;
+}
+
+#define _ENDSTOP_INT_VECT(n) INT ## n ## _vect
+#define ENDSTOP_INT_VECT(n) _ENDSTOP_INT_VECT(n)
+
+// Any edge on INTn
+#define ENDSTOP_INT_INIT(n) { \
+    if ((n) < 4) EICRA = (EICRA & ~(3 << (2 * ((n) & 3)))) | (1 << (2 * ((n) & 3))); \
+    else         EICRB = (EICRB & ~(3 << (2 * ((n) & 3)))) | (1 << (2 * ((n) & 3))); \
+    EIFR = (1 << (n)); EIMSK |= (1 << (n)); }
+
+#define ENDSTOP_PCINT_INIT(n) { PCMSK0 |= (1 << (n)); PCIFR = (1 << PCIF0); PCICR |= (1 << PCIE0); }
+
+#if defined(X_STOP_INT) && defined(X_ENDSTOP_INTERRUPT)
+ISR(ENDSTOP_INT_VECT(X_STOP_INT)) { endstops_check_latched(); }
+#endif
+#if defined(Y_STOP_INT) && defined(Y_ENDSTOP_INTERRUPT)
+ISR(ENDSTOP_INT_VECT(Y_STOP_INT)) { endstops_check_latched(); }
+#endif
+#if defined(Z_STOP_INT) && defined(Z_ENDSTOP_INTERRUPT)
+ISR(ENDSTOP_INT_VECT(Z_STOP_INT)) { endstops_check_latched(); }
+#endif
+#if (defined(X_STOP_PCINT) && defined(X_ENDSTOP_INTERRUPT)) || \
+    (defined(Y_STOP_PCINT) && defined(Y_ENDSTOP_INTERRUPT)) || \
+    (defined(Z_STOP_PCINT) && defined(Z_ENDSTOP_INTERRUPT))
+ISR(PCINT0_vect) { endstops_check_latched(); }
+#endif
+
+static void endstop_interrupts_init()
+{
+  #ifdef X_ENDSTOP_INTERRUPT
+    #ifdef X_STOP_INT
+      ENDSTOP_INT_INIT(X_STOP_INT);
+    #else
+      ENDSTOP_PCINT_INIT(X_STOP_PCINT);
+    #endif
+  #endif
+  #ifdef Y_ENDSTOP_INTERRUPT
+    #ifdef Y_STOP_INT
+      ENDSTOP_INT_INIT(Y_STOP_INT);
+    #else
+      ENDSTOP_PCINT_INIT(Y_STOP_PCINT);
+    #endif
+  #endif
+  #ifdef Z_ENDSTOP_INTERRUPT
+    #ifdef Z_STOP_INT
+      ENDSTOP_INT_INIT(Z_STOP_INT);
+    #else
+      ENDSTOP_PCINT_INIT(Z_STOP_PCINT);
+    #endif
+  #endif
+}
+#endif // ENDSTOP_INTERRUPTS
+
 //         __________________________
 //        /|                        |\     _________________         ^
 //       / |                        | \   /|               |\        |
@@ -432,33 +876,36 @@ void step_wait(){
 }
 
 
-FORCE_INLINE unsigned short calc_timer(unsigned short step_rate) {
+// step_rate to timer interval for a block.  The steps per interrupt that rate
+// needs are returned in loops (step_loops, or step_loops_shift for the L6470).
+FORCE_INLINE unsigned short calc_timer_loops(block_t *block, unsigned short step_rate, uint8_t &loops) {
   unsigned short timer;
+#if !defined(USE_L6470) || USE_L6470 == 0
   if(step_rate > MAX_STEP_FREQUENCY) step_rate = MAX_STEP_FREQUENCY;
 
   if(step_rate > 20000) { // If steprate > 20kHz >> step 4 times
     step_rate = (step_rate >> 2)&0x3fff;
-#if !defined(USE_L6470) || USE_L6470 == 0
-	step_loops = 4;
-#else
-    step_loops_shift = 2;  // step_loops = 4;
-#endif
+	loops = 4;
   }
   else if(step_rate > 10000) { // If steprate > 10kHz >> step 2 times
     step_rate = (step_rate >> 1)&0x7fff;
-#if !defined(USE_L6470) || USE_L6470 == 0
-	step_loops = 2;
-#else
-    step_loops_shift = 1;
-#endif
+	loops = 2;
   }
   else {
-#if !defined(USE_L6470) || USE_L6470 == 0
-    step_loops = 1;
+    loops = 1;
+  }
 #else
-    step_loops_shift = 0;
-#endif
+  // Take the fewest steps per interrupt that keep SPI use within budget, but
+  // never more than the block allows.  Re-evaluated at every rate change, so
+  // the shift follows the ramps up and down.
+  loops = 0;
+  while (loops < block->step_shift && step_rate > block->max_isr_rate) {
+    step_rate >>= 1;
+    loops++;
   }
+  // With multiple steps per interrupt this limits the interrupt rate, not the step rate
+  if(step_rate > MAX_STEP_FREQUENCY) step_rate = MAX_STEP_FREQUENCY;
+#endif
 
   if(step_rate < (F_CPU/500000)) step_rate = (F_CPU/500000);
   step_rate -= (F_CPU/500000); // Correct for minimal speed
@@ -479,6 +926,17 @@ FORCE_INLINE unsigned short calc_timer(unsigned short step_rate) {
   return timer;
 }
 
+FORCE_INLINE unsigned short calc_timer(unsigned short step_rate) {
+  uint8_t loops;
+  unsigned short timer = calc_timer_loops(current_block, step_rate, loops);
+#if !defined(USE_L6470) || USE_L6470 == 0
+  step_loops = loops;
+#else
+  step_loops_shift = loops;
+#endif
+  return timer;
+}
+
 // Initializes the trapezoid generator from the current block. Called whenever a new
 // block begins.
 FORCE_INLINE void trapezoid_generator_reset() {
@@ -514,17 +972,698 @@ FORCE_INLINE void trapezoid_generator_reset() {
 
 }
 
+#ifdef STEPPER_RAMP_TABLE
+// Ramp table: the timer intervals of the acceleration and deceleration ramps of
+// the current block, worked out ahead of the stepper interrupt by st_ramp_fill()
+// in the main loop.  The fill replays the interrupt's own trapezoid arithmetic,
+// so an entry holds exactly what the interrupt would have computed for that
+// interrupt.  When the ring runs dry the interrupt computes the interval itself.
+typedef struct {
+  unsigned short tick;   // Interrupt of the block the entry is for
+  unsigned short rate;   // Step rate at that interrupt
+  unsigned short timer;  // OCR1A for it
+  uint8_t loops;         // step_loops / step_loops_shift for it
+} ramp_entry_t;
+
+static ramp_entry_t ramp_ring[RAMP_TABLE_SIZE];
+static volatile uint8_t ramp_head, ramp_tail;   // Filled at the head, taken at the tail
+static volatile uint8_t ramp_block_count;       // Bumped each time the interrupt takes a new block
+static volatile unsigned short ramp_tick;       // Interrupts run in the current block
+
+#define RAMP_NEXT(i) (((i) + 1) & (RAMP_TABLE_SIZE - 1))
+
+// The interrupt took a new block: drop what was queued for the last one
+FORCE_INLINE void ramp_reset() {
+  ramp_head = ramp_tail = 0;
+  ramp_tick = 0;
+  ramp_block_count++;
+}
+
+// Take the entry for this interrupt, if st_ramp_fill() got to it in time
+FORCE_INLINE bool ramp_lookup(unsigned short &rate, unsigned short &timer) {
+  uint8_t t = ramp_tail;
+  if (t == ramp_head || ramp_ring[t].tick != ramp_tick) return false;
+  rate = ramp_ring[t].rate;
+  timer = ramp_ring[t].timer;
+#if !defined(USE_L6470) || USE_L6470 == 0
+  step_loops = ramp_ring[t].loops;
+#else
+  step_loops_shift = ramp_ring[t].loops;
+#endif
+  ramp_tail = RAMP_NEXT(t);
+  return true;
+}
+
+void st_ramp_fill()
+{
+  static uint8_t block_count;
+  static block_t *block = NULL;
+  static unsigned long events;        // step_events_completed
+  static unsigned short tick;
+  static unsigned short acc_rate;     // acc_step_rate
+  static long acc_time, dec_time;     // acceleration_time, deceleration_time
+  static uint8_t loops, loops_nominal;
+
+  bool new_block;
+  {
+    CRITICAL_SECTION_START;
+    new_block = (block_count != ramp_block_count);
+    if (new_block) {
+      block_count = ramp_block_count;
+      block = current_block;
+    }
+    CRITICAL_SECTION_END;
+  }
+  if (block == NULL) return;
+  if (new_block) {
+    // As trapezoid_generator_reset()
+    events = 0;
+    tick = 0;
+    calc_timer_loops(block, block->nominal_rate, loops_nominal);
+    acc_rate = block->initial_rate;
+    acc_time = calc_timer_loops(block, acc_rate, loops);
+    dec_time = 0;
+  }
+
+  // Bound the work per call; a fill that fell behind catches up over a few calls
+  for (uint8_t n = 2 * RAMP_TABLE_SIZE; n && events < block->step_event_count; n--) {
+    if (RAMP_NEXT(ramp_head) == ramp_tail) return;  // Ring is full
+
+    // The step events of this interrupt
+#if !defined(USE_L6470) || USE_L6470 == 0
+    events += loops;
+    if (events > block->step_event_count) events = block->step_event_count;
+#else
+    while (loops && (events + (1 << loops)) > block->step_event_count)
+      --loops;
+    events += 1 << loops;
+#endif
+
+    unsigned short rate, timer;
+    if (events <= (unsigned long int)block->accelerate_until) {
+      MultiU24X24toH16(acc_rate, acc_time, block->acceleration_rate);
+      acc_rate += block->initial_rate;
+      if(acc_rate > block->nominal_rate)
+        acc_rate = block->nominal_rate;
+      rate = acc_rate;
+      timer = calc_timer_loops(block, rate, loops);
+      acc_time += timer;
+    }
+    else if (events > (unsigned long int)block->decelerate_after) {
+      MultiU24X24toH16(rate, dec_time, block->acceleration_rate);
+      if(rate > acc_rate)
+        rate = block->final_rate;
+      else
+        rate = acc_rate - rate;
+      if(rate < block->final_rate)
+        rate = block->final_rate;
+      timer = calc_timer_loops(block, rate, loops);
+      dec_time += timer;
+    }
+    else {
+      // Cruising needs no table; skip to the last interrupt before the deceleration
+      loops = loops_nominal;
+#if !defined(USE_L6470) || USE_L6470 == 0
+      unsigned long skip = (block->decelerate_after - events) / loops;
+      events += skip * loops;
+#else
+      unsigned long skip = (block->decelerate_after - events) >> loops;
+      events += skip << loops;
+#endif
+      tick += skip + 1;
+      continue;
+    }
+
+    bool stale;
+    {
+      CRITICAL_SECTION_START;
+      stale = (block_count != ramp_block_count);
+      if (!stale && tick >= ramp_tick) {
+        ramp_entry_t *e = &ramp_ring[ramp_head];
+        e->tick = tick;
+        e->rate = rate;
+        e->timer = timer;
+        e->loops = loops;
+        ramp_head = RAMP_NEXT(ramp_head);
+      }
+      CRITICAL_SECTION_END;
+    }
+    if (stale) return;
+    tick++;
+  }
+}
+#endif // STEPPER_RAMP_TABLE
+
+#ifdef STEPPER_ISR_PROFILE
+// Stepper ISR profiler: duration histograms per path through the ISR, in
+// timer 1 ticks (0.5us).  Bucket 0 holds interrupts shorter than 8us and
+// every further bucket doubles that, the last one takes everything longer.
+static unsigned short isr_prof_hist[ISR_PATHS][ISR_PROFILE_BUCKETS];
+static unsigned short isr_prof_max[ISR_PATHS];
+static unsigned long isr_prof_busy_ticks;
+static unsigned long isr_prof_start_ms;
+static unsigned short isr_prof_overruns;
+unsigned short isr_prof_bsy_timeouts;
+#ifdef INDEPENDENT_AXIS_TIMING
+static unsigned short isr_prof_phase_late;  // Latest compare B pulse, in timer ticks
+#endif
+
+#define ISR_PROFILE_PATH(p) { if (isr_path == ISR_PATH_IDLE) isr_path = (p); }
+
+FORCE_INLINE void isr_profile_record(uint8_t path, unsigned short entry) {
+  // A compare match during the ISR, or an OCR1A already behind TCNT1, makes
+  // the next step late.  After a match the timer has restarted from 0 (CTC),
+  // so the time spent is what it counted up to OCR1A plus what it has counted
+  // since.  The flag is read first; a TCNT1 below the entry means the match
+  // came just after.
+  bool matched = (TIFR1 & (1<<OCF1A)) != 0;
+  unsigned short now = TCNT1;
+  if (now < entry) matched = true;
+  unsigned short ticks = matched ? OCR1A + 1 - entry + now : now - entry;
+  if (matched || now >= OCR1A) isr_prof_overruns++;
+  isr_prof_busy_ticks += ticks;
+
+  uint8_t bucket = 0;
+  for (unsigned short t = ticks >> 4; t && bucket < ISR_PROFILE_BUCKETS - 1; t >>= 1) bucket++;
+  if (++isr_prof_hist[path][bucket] == 0xFFFF) {
+    // keep the shape of the histogram rather than saturate
+    for (uint8_t i = 0; i < ISR_PROFILE_BUCKETS; i++) isr_prof_hist[path][i] >>= 1;
+  }
+  if (ticks > isr_prof_max[path]) isr_prof_max[path] = ticks;
+}
+
+void st_isr_profile_reset()
+{
+  CRITICAL_SECTION_START;
+  memset(isr_prof_hist, 0, sizeof(isr_prof_hist));
+  memset(isr_prof_max, 0, sizeof(isr_prof_max));
+  isr_prof_busy_ticks = 0;
+  isr_prof_overruns = 0;
+  isr_prof_bsy_timeouts = 0;
+  #ifdef INDEPENDENT_AXIS_TIMING
+    isr_prof_phase_late = 0;
+  #endif
+  isr_prof_start_ms = millis();
+  CRITICAL_SECTION_END;
+}
+
+void st_isr_profile_report()
+{
+  unsigned short hist[ISR_PATHS][ISR_PROFILE_BUCKETS], maxticks[ISR_PATHS];
+  unsigned long busy_ticks;
+  unsigned short overruns, bsy_timeouts;
+  CRITICAL_SECTION_START;
+  memcpy(hist, isr_prof_hist, sizeof(hist));
+  memcpy(maxticks, isr_prof_max, sizeof(maxticks));
+  busy_ticks = isr_prof_busy_ticks;
+  overruns = isr_prof_overruns;
+  bsy_timeouts = isr_prof_bsy_timeouts;
+  CRITICAL_SECTION_END;
+
+  unsigned long elapsed_ms = millis() - isr_prof_start_ms;
+  SERIAL_ECHO_START;
+  SERIAL_ECHOPGM("ISR load:");
+  // busy ticks are 0.5us, so ticks / (20 * ms) is the percentage
+  SERIAL_ECHO(elapsed_ms ? (float)busy_ticks / (20.0 * elapsed_ms) : 0.0);
+  SERIAL_ECHOPGM("% overruns:");
+  SERIAL_ECHO(overruns);
+  SERIAL_ECHOPGM(" bsy_timeouts:");
+  SERIAL_ECHO(bsy_timeouts);
+  #ifdef INDEPENDENT_AXIS_TIMING
+    SERIAL_ECHOPGM(" phase_late(us):");
+    SERIAL_ECHO(isr_prof_phase_late >> 1);
+  #endif
+  SERIAL_ECHOLNPGM(" buckets(us):<8 <16 <32 <64 <128 <256 <512 >=512");
+  for (uint8_t path = 0; path < ISR_PATHS; path++) {
+    SERIAL_ECHO_START;
+    switch(path) {
+      case ISR_PATH_IDLE:        SERIAL_ECHOPGM("idle"); break;
+      case ISR_PATH_BLOCK_START: SERIAL_ECHOPGM("block_start"); break;
+      case ISR_PATH_ACCEL:       SERIAL_ECHOPGM("accel"); break;
+      case ISR_PATH_CRUISE:      SERIAL_ECHOPGM("cruise"); break;
+      case ISR_PATH_DECEL:       SERIAL_ECHOPGM("decel"); break;
+      case ISR_PATH_ENDSTOP:     SERIAL_ECHOPGM("endstop"); break;
+    }
+    SERIAL_ECHOPGM(" max(us):");
+    SERIAL_ECHO(maxticks[path] >> 1);
+    SERIAL_ECHOPGM(" :");
+    for (uint8_t i = 0; i < ISR_PROFILE_BUCKETS; i++) {
+      SERIAL_ECHOPGM(" ");
+      SERIAL_ECHO(hist[path][i]);
+    }
+    SERIAL_ECHOLN("");
+  }
+}
+
+unsigned short st_isr_load()
+{
+  static unsigned long last_busy_ticks, last_ms;
+  unsigned long busy_ticks, now = millis();
+  CRITICAL_SECTION_START;
+  busy_ticks = isr_prof_busy_ticks;
+  CRITICAL_SECTION_END;
+  // M216 R may have reset the count since the last call
+  unsigned long ticks = busy_ticks >= last_busy_ticks ? busy_ticks - last_busy_ticks : busy_ticks;
+  unsigned long elapsed_ms = now - last_ms;
+  last_busy_ticks = busy_ticks;
+  last_ms = now;
+  // busy ticks are 0.5us, so ticks * 5 / ms is the load in 1/100 %
+  return elapsed_ms ? min(ticks * 5 / elapsed_ms, 10000UL) : 0;
+}
+#else
+#define ISR_PROFILE_PATH(p)
+#endif // STEPPER_ISR_PROFILE
+
+#if USE_L6470 == 1
+// Run the bresenham tracer for 1 << step_loops_shift step events at once and
+// return how many steps the axis takes.  The counter ends up exactly where
+// single stepping would have left it, so coarse interrupts never lose steps.
+FORCE_INLINE uint8_t l6470_bresenham(long &counter, long steps) {
+  uint8_t n = 0;
+  counter += steps << step_loops_shift;
+  while (counter > 0) {
+    counter -= current_block->step_event_count;
+    n++;
+  }
+  return n;
+}
+#endif
+
+// Per-axis driver traits.  Each axis gets a struct with the same static
+// interface, picked at compile time from the driver the axis has:
+//   set_dir(neg)           latch the direction for the coming block
+//   step_high/step_low()   one step pulse (STEP/DIR style drivers)
+//   steps(n)               n steps at once (multistepping L6470 builds)
+// load_axis_dir<>() and step_axis<>() are written once against that interface,
+// so every axis inlines to straight-line code for its own driver and mixed
+// driver setups need no extra branches.
+
+// n pulses with at least 1us high and low time
+#define PIN_DRIVER_STEPS(nsteps) \
+  static FORCE_INLINE void steps(uint8_t n) { \
+    for (unsigned short i = (unsigned short)n * (nsteps); i; i--) { \
+      step_high(); _delay_us(1); step_low(); _delay_us(1); \
+    } \
+  }
+
+#if USE_L6470 == 1
+// An L6470 that is handed each step count as a MOVE over SPI
+#define L6470_SPI_DRIVER(l6470, AXIS, invert_dir) \
+  static FORCE_INLINE void set_dir(bool neg) { l6470.setDir((neg != invert_dir) ? L6470_FWD : L6470_REV); } \
+  static FORCE_INLINE void steps(uint8_t n) { \
+    L6470_WAIT_BSY(AXIS##_L6470_BSY_PIN); \
+    l6470.move(AXIS##_L6470_NSTEPS * n); \
+  }
+
+// An L6470 in step-clock mode, stepped by pulses on its STCK pin.  The
+// STEP_CLOCK command that sets the direction also (re)enters the mode.
+#define L6470_STCK_DRIVER(l6470, AXIS, invert_dir) \
+  static FORCE_INLINE void set_dir(bool neg) { l6470.stepClock((neg != invert_dir) ? L6470_FWD : L6470_REV); } \
+  static FORCE_INLINE void step_high() { WRITE(AXIS##_L6470_STCK_PIN, HIGH); } \
+  static FORCE_INLINE void step_low() { WRITE(AXIS##_L6470_STCK_PIN, LOW); } \
+  PIN_DRIVER_STEPS(AXIS##_L6470_NSTEPS)
+#endif
+
+struct x_driver {
+#if defined(X_L6470_CS_PIN) && (X_L6470_CS_PIN > -1)
+  #ifdef DUAL_X_CARRIAGE
+    #error Not yet implemented for L6470 drivers
+  #endif
+  #if defined(X_L6470_STCK_PIN) && (X_L6470_STCK_PIN > -1)
+    L6470_STCK_DRIVER(l6470_x, X, INVERT_X_DIR)
+  #else
+    L6470_SPI_DRIVER(l6470_x, X, INVERT_X_DIR)
+  #endif
+#else
+  static FORCE_INLINE void set_dir(bool neg) {
+    #ifdef DUAL_X_CARRIAGE
+      if (extruder_duplication_enabled){
+        WRITE(X_DIR_PIN, neg ? INVERT_X_DIR : !INVERT_X_DIR);
+        WRITE(X2_DIR_PIN, neg ? INVERT_X_DIR : !INVERT_X_DIR);
+      }
+      else{
+        if (current_block->active_extruder != 0)
+          WRITE(X2_DIR_PIN, neg ? INVERT_X_DIR : !INVERT_X_DIR);
+        else
+          WRITE(X_DIR_PIN, neg ? INVERT_X_DIR : !INVERT_X_DIR);
+      }
+    #else
+      WRITE(X_DIR_PIN, neg ? INVERT_X_DIR : !INVERT_X_DIR);
+    #endif
+  }
+  static FORCE_INLINE void step_high() {
+    #ifdef DUAL_X_CARRIAGE
+      if (extruder_duplication_enabled){
+        WRITE(X_STEP_PIN, !INVERT_X_STEP_PIN);
+        WRITE(X2_STEP_PIN, !INVERT_X_STEP_PIN);
+      }
+      else {
+        if (current_block->active_extruder != 0)
+          WRITE(X2_STEP_PIN, !INVERT_X_STEP_PIN);
+        else
+          WRITE(X_STEP_PIN, !INVERT_X_STEP_PIN);
+      }
+    #else
+      WRITE(X_STEP_PIN, !INVERT_X_STEP_PIN);
+    #endif
+  }
+  static FORCE_INLINE void step_low() {
+    #ifdef DUAL_X_CARRIAGE
+      if (extruder_duplication_enabled){
+        WRITE(X_STEP_PIN, INVERT_X_STEP_PIN);
+        WRITE(X2_STEP_PIN, INVERT_X_STEP_PIN);
+      }
+      else {
+        if (current_block->active_extruder != 0)
+          WRITE(X2_STEP_PIN, INVERT_X_STEP_PIN);
+        else
+          WRITE(X_STEP_PIN, INVERT_X_STEP_PIN);
+      }
+    #else
+      WRITE(X_STEP_PIN, INVERT_X_STEP_PIN);
+    #endif
+  }
+  PIN_DRIVER_STEPS(1)
+#endif
+};
+
+struct y_driver {
+#if defined(Y_L6470_CS_PIN) && (Y_L6470_CS_PIN > -1)
+  #ifdef Y_DUAL_STEPPER_DRIVERS
+    #error Not yet implemented for L6470 drivers
+  #endif
+  #if defined(Y_L6470_STCK_PIN) && (Y_L6470_STCK_PIN > -1)
+    L6470_STCK_DRIVER(l6470_y, Y, INVERT_Y_DIR)
+  #else
+    L6470_SPI_DRIVER(l6470_y, Y, INVERT_Y_DIR)
+  #endif
+#else
+  static FORCE_INLINE void set_dir(bool neg) {
+    WRITE(Y_DIR_PIN, neg ? INVERT_Y_DIR : !INVERT_Y_DIR);
+    #ifdef Y_DUAL_STEPPER_DRIVERS
+      WRITE(Y2_DIR_PIN, neg ? !(INVERT_Y_DIR == INVERT_Y2_VS_Y_DIR) : (INVERT_Y_DIR == INVERT_Y2_VS_Y_DIR));
+    #endif
+  }
+  static FORCE_INLINE void step_high() {
+    WRITE(Y_STEP_PIN, !INVERT_Y_STEP_PIN);
+    #ifdef Y_DUAL_STEPPER_DRIVERS
+      WRITE(Y2_STEP_PIN, !INVERT_Y_STEP_PIN);
+    #endif
+  }
+  static FORCE_INLINE void step_low() {
+    WRITE(Y_STEP_PIN, INVERT_Y_STEP_PIN);
+    #ifdef Y_DUAL_STEPPER_DRIVERS
+      WRITE(Y2_STEP_PIN, INVERT_Y_STEP_PIN);
+    #endif
+  }
+  PIN_DRIVER_STEPS(1)
+#endif
+};
+
+struct z_driver {
+#if defined(Z_L6470_CS_PIN) && (Z_L6470_CS_PIN > -1)
+  #ifdef Z_DUAL_STEPPER_DRIVERS
+    #error Not yet implemented for the L6470 driver
+  #endif
+  #if defined(Z_L6470_STCK_PIN) && (Z_L6470_STCK_PIN > -1)
+    L6470_STCK_DRIVER(l6470_z, Z, INVERT_Z_DIR)
+  #else
+    L6470_SPI_DRIVER(l6470_z, Z, INVERT_Z_DIR)
+  #endif
+#else
+  static FORCE_INLINE void set_dir(bool neg) {
+    WRITE(Z_DIR_PIN, neg ? INVERT_Z_DIR : !INVERT_Z_DIR);
+    #ifdef Z_DUAL_STEPPER_DRIVERS
+      WRITE(Z2_DIR_PIN, neg ? INVERT_Z_DIR : !INVERT_Z_DIR);
+    #endif
+  }
+  static FORCE_INLINE void step_high() {
+    WRITE(Z_STEP_PIN, !INVERT_Z_STEP_PIN);
+    #ifdef Z_DUAL_STEPPER_DRIVERS
+      WRITE(Z2_STEP_PIN, !INVERT_Z_STEP_PIN);
+    #endif
+  }
+  static FORCE_INLINE void step_low() {
+    WRITE(Z_STEP_PIN, INVERT_Z_STEP_PIN);
+    #ifdef Z_DUAL_STEPPER_DRIVERS
+      WRITE(Z2_STEP_PIN, INVERT_Z_STEP_PIN);
+    #endif
+  }
+  PIN_DRIVER_STEPS(1)
+#endif
+};
+
+// The extruders go through the E macros of stepper.h, which pick the active extruder
+struct e_driver {
+  static FORCE_INLINE void set_dir(bool neg) {
+    if (neg) REV_E_DIR(); else NORM_E_DIR();
+  }
+#if USE_L6470 == 1
+  static FORCE_INLINE void steps(uint8_t n) { WRITE_E_STEPS(n); }
+#else
+  static FORCE_INLINE void step_high() { WRITE_E_STEP(!INVERT_E_STEP_PIN); }
+  static FORCE_INLINE void step_low() { WRITE_E_STEP(INVERT_E_STEP_PIN); }
+#endif
+};
+
+// Latch the direction of an axis for the block and the sign its position counts with
+template<class D, uint8_t AXIS> FORCE_INLINE void load_axis_dir() {
+  bool neg = (out_bits & (1<<AXIS)) != 0;
+  D::set_dir(neg);
+  count_direction[AXIS] = neg ? -1 : 1;
+}
+
+// Trace an axis for this interrupt and step it when the tracer says so
+template<class D, uint8_t AXIS> FORCE_INLINE void step_axis(long &counter, long steps) {
+  #if USE_L6470 == 1
+    uint8_t n = l6470_bresenham(counter, steps);
+    if (n) {
+      D::steps(n);
+      count_position[AXIS] += count_direction[AXIS] * n;
+    }
+  #else
+    counter += steps;
+    if (counter > 0) {
+      D::step_high();
+      counter -= current_block->step_event_count;
+      count_position[AXIS] += count_direction[AXIS];
+      D::step_low();
+    }
+  #endif
+}
+
+#ifdef INDEPENDENT_AXIS_TIMING
+#if USE_L6470 == 1
+  #error INDEPENDENT_AXIS_TIMING needs STEP/DIR drivers; the L6470 are handed whole MOVEs
+#endif
+// Independent axis timing.  The bresenham tracer still decides which interrupt
+// every step belongs to, so step counts stay exact, but instead of pulsing at
+// the interrupt each axis is pulsed where its ideal step falls: the tracer's
+// overshoot says how far into the last interval the axis crossed its step, and
+// the pulse is placed as far into the interval that just started.  All axes
+// lag one interval, the dominant axis steps mid-interval and minor axes no
+// longer snap to its steps.  The pulses of an interval are queued in time
+// order and fired by timer 1 compare B.
+#define PHASE_LEAD 4   // Pulses due within 2us are fired right away
+
+static unsigned short phase_recip[NUM_AXIS];  // 65535 / (steps >> phase_shift), per block
+static uint8_t phase_shift[NUM_AXIS];
+static uint8_t phase_frac[NUM_AXIS];          // Where the axis steps in the interval, /256
+static uint8_t phase_due;                     // Axes that step in the coming interval
+static unsigned short phase_time[NUM_AXIS];   // Queued pulses, in time order
+static uint8_t phase_axes[NUM_AXIS];
+static volatile uint8_t phase_count, phase_next;
+
+FORCE_INLINE void phase_load_axis(uint8_t axis, long steps) {
+  uint8_t s = 0;
+  while ((steps >> s) > 255) s++;
+  phase_shift[axis] = s;
+  phase_recip[axis] = steps ? 65535U / (unsigned short)(steps >> s) : 0;
+}
+
+// Trace an axis and note where in the interval it steps
+template<uint8_t AXIS> FORCE_INLINE void phase_axis(long &counter, long steps) {
+  counter += steps;
+  if (counter > 0) {
+    // The step fell (steps - counter) / steps of the way through the last interval
+    uint8_t a = (uint8_t)((steps - counter) >> phase_shift[AXIS]);
+    phase_frac[AXIS] = ((unsigned long)a * phase_recip[AXIS]) >> 8;
+    phase_due |= (1<<AXIS);
+    counter -= current_block->step_event_count;
+    count_position[AXIS] += count_direction[AXIS];
+  }
+}
+
+FORCE_INLINE void phase_pulse(uint8_t axes) {
+  if (axes & (1<<X_AXIS)) x_driver::step_high();
+  if (axes & (1<<Y_AXIS)) y_driver::step_high();
+  if (axes & (1<<Z_AXIS)) z_driver::step_high();
+  #ifndef ADVANCE
+    if (axes & (1<<E_AXIS)) e_driver::step_high();
+  #endif
+  _delay_us(1);
+  if (axes & (1<<X_AXIS)) x_driver::step_low();
+  if (axes & (1<<Y_AXIS)) y_driver::step_low();
+  if (axes & (1<<Z_AXIS)) z_driver::step_low();
+  #ifndef ADVANCE
+    if (axes & (1<<E_AXIS)) e_driver::step_low();
+  #endif
+}
+
+// Fire the queued pulses that are due and arm compare B for the next one
+FORCE_INLINE void phase_fire() {
+  while (phase_next < phase_count) {
+    unsigned short now = TCNT1;
+    uint8_t axes = 0;
+    #ifdef STEPPER_ISR_PROFILE
+      if (now > phase_time[phase_next] && now - phase_time[phase_next] > isr_prof_phase_late)
+        isr_prof_phase_late = now - phase_time[phase_next];
+    #endif
+    while (phase_next < phase_count && phase_time[phase_next] <= now + PHASE_LEAD)
+      axes |= phase_axes[phase_next++];
+    if (axes) {
+      phase_pulse(axes);
+      continue;
+    }
+    OCR1B = phase_time[phase_next];
+    TIFR1 = (1<<OCF1B);
+    TIMSK1 |= (1<<OCIE1B);
+    if (TCNT1 < phase_time[phase_next]) return;
+    // The compare went by while it was armed; fire it here
+  }
+  TIMSK1 &= ~(1<<OCIE1B);
+}
+
+// Fire whatever is still queued, now
+FORCE_INLINE void phase_flush() {
+  uint8_t axes = 0;
+  while (phase_next < phase_count) axes |= phase_axes[phase_next++];
+  if (axes) phase_pulse(axes);
+  TIMSK1 &= ~(1<<OCIE1B);
+}
+
+// Queue the pulses traced in this interrupt across the interval that just started
+FORCE_INLINE void phase_schedule(unsigned short timer) {
+  phase_count = phase_next = 0;
+  for (uint8_t axis = 0; axis < NUM_AXIS; axis++) {
+    if (!(phase_due & (1<<axis))) continue;
+    unsigned short t;
+    uint8_t frac = phase_frac[axis];
+    MultiU16X8toH16(t, frac, timer);
+    uint8_t i = phase_count;
+    while (i && phase_time[i - 1] > t) {
+      phase_time[i] = phase_time[i - 1];
+      phase_axes[i] = phase_axes[i - 1];
+      i--;
+    }
+    phase_time[i] = t;
+    phase_axes[i] = (1<<axis);
+    phase_count++;
+  }
+  phase_due = 0;
+  phase_fire();
+}
+
+ISR(TIMER1_COMPB_vect)
+{
+  phase_fire();
+}
+#endif // INDEPENDENT_AXIS_TIMING
+
+// Per-block setup, run once when the ISR picks up a new block.  Directions can
+// only change at a block boundary, so the direction pins, the L6470 direction and
+// count_direction[] are set here and the per-tick path only traces and steps.
+FORCE_INLINE void st_load_block() {
+  out_bits = current_block->direction_bits;
+
+  block_axes = 0;
+  if (current_block->steps_x > 0) block_axes |= (1<<X_AXIS);
+  if (current_block->steps_y > 0) block_axes |= (1<<Y_AXIS);
+  if (current_block->steps_z > 0) block_axes |= (1<<Z_AXIS);
+  if (current_block->steps_e > 0) block_axes |= (1<<E_AXIS);
+
+  // X_AXIS=A_AXIS and Y_AXIS=B_AXIS for COREXY
+  load_axis_dir<x_driver, X_AXIS>();
+  load_axis_dir<y_driver, Y_AXIS>();
+  load_axis_dir<z_driver, Z_AXIS>();
+  #ifndef ADVANCE
+    load_axis_dir<e_driver, E_AXIS>();
+  #endif
+
+  #ifdef INDEPENDENT_AXIS_TIMING
+    phase_load_axis(X_AXIS, current_block->steps_x);
+    phase_load_axis(Y_AXIS, current_block->steps_y);
+    phase_load_axis(Z_AXIS, current_block->steps_z);
+    phase_load_axis(E_AXIS, current_block->steps_e);
+  #endif
+}
+
+#ifdef POWER_LOSS_RESUME
+// The SD command that made the last block is done when a block of another command
+// starts or the buffer runs dry; keep what it left and the positions it ended at
+static plan_resume_t st_block_resume;  // of the blocks being stepped
+static plan_resume_t st_checkpoint_resume;
+static long st_checkpoint_steps[NUM_AXIS];
+static bool st_checkpoint_new = false;
+
+FORCE_INLINE void st_checkpoint_track() {
+  unsigned long sdpos = current_block != NULL ? current_block->resume.sdpos : 0;
+  if (sdpos != st_block_resume.sdpos) {
+    if (st_block_resume.sdpos) {
+      st_checkpoint_resume = st_block_resume;
+      for (uint8_t i = 0; i < NUM_AXIS; i++) st_checkpoint_steps[i] = count_position[i];
+      st_checkpoint_new = true;
+    }
+    if (current_block != NULL)
+      st_block_resume = current_block->resume;
+    else
+      st_block_resume.sdpos = 0;
+  }
+}
+
+bool st_checkpoint(plan_resume_t &resume, long *steps)
+{
+  bool fresh;
+  CRITICAL_SECTION_START;
+  fresh = st_checkpoint_new;
+  st_checkpoint_new = false;
+  resume = st_checkpoint_resume;
+  memcpy(steps, st_checkpoint_steps, sizeof(st_checkpoint_steps));
+  CRITICAL_SECTION_END;
+  return fresh;
+}
+#endif
+
 // "The Stepper Driver Interrupt" - This timer interrupt is the workhorse.
 // It pops blocks from the block_buffer and executes them by pulsing the stepper pins appropriately.
 ISR(TIMER1_COMPA_vect)
 {
+  #ifdef STEPPER_ISR_PROFILE
+    // TCNT1 restarts from 0 on every compare match, so it reads the time since this interrupt was due
+    unsigned short isr_entry = TCNT1;
+    bool isr_was_hit = endstop_x_hit || endstop_y_hit || endstop_z_hit;
+    uint8_t isr_path = ISR_PATH_IDLE;
+  #endif
   // If there is no current block, attempt to pop one from the buffer
   if (current_block == NULL) {
     // Anything in the buffer?
     current_block = plan_get_current_block();
+    #ifdef POWER_LOSS_RESUME
+      st_checkpoint_track();
+    #endif
     if (current_block != NULL) {
       current_block->busy = true;
       trapezoid_generator_reset();
+      st_load_block();
+      #ifdef STEPPER_RAMP_TABLE
+        ramp_reset();
+      #endif
+      ISR_PROFILE_PATH(ISR_PATH_BLOCK_START);
+      #ifdef ENDSTOP_INTERRUPTS
+        // A switch that is already closed gives no edge
+        endstop_latched = 0;
+        endstops_check_latched();
+      #endif
       counter_x = -(current_block->step_event_count >> 1);
       counter_y = counter_x;
       counter_z = counter_x;
@@ -549,83 +1688,8 @@ ISR(TIMER1_COMPA_vect)
   }
 
   if (current_block != NULL) {
-    // Set directions TO DO This should be done once during init of trapezoid. Endstops -> interrupt
-    out_bits = current_block->direction_bits;
-
-
-    // Set the direction bits (X_AXIS=A_AXIS and Y_AXIS=B_AXIS for COREXY)
-    if((out_bits & (1<<X_AXIS))!=0){
-      #ifdef DUAL_X_CARRIAGE
-		#if defined(X_L6470_CS_PIN) && (X_L6470_CS_PIN > -1)
-		  #error Not yet implemented for L6470 drivers
-		#endif
-        if (extruder_duplication_enabled){
-          WRITE(X_DIR_PIN, INVERT_X_DIR);
-          WRITE(X2_DIR_PIN, INVERT_X_DIR);
-        }
-        else{
-          if (current_block->active_extruder != 0)
-            WRITE(X2_DIR_PIN, INVERT_X_DIR);
-          else
-            WRITE(X_DIR_PIN, INVERT_X_DIR);
-        }
-      #elif defined(X_L6470_CS_PIN) && (X_L6470_CS_PIN > -1)
-		l6470_x.setDir(INVERT_X_DIR ? L6470_REV : L6470_FWD);
-	  #else
-        WRITE(X_DIR_PIN, INVERT_X_DIR);
-      #endif        
-      count_direction[X_AXIS]=-1;
-    }
-    else{
-      #ifdef DUAL_X_CARRIAGE
-        if (extruder_duplication_enabled){
-          WRITE(X_DIR_PIN, !INVERT_X_DIR);
-          WRITE(X2_DIR_PIN, !INVERT_X_DIR);
-        }
-        else{
-          if (current_block->active_extruder != 0)
-            WRITE(X2_DIR_PIN, !INVERT_X_DIR);
-          else
-            WRITE(X_DIR_PIN, !INVERT_X_DIR);
-        }
-      #elif defined(X_L6470_CS_PIN) && (X_L6470_CS_PIN > -1)
-		l6470_x.setDir(INVERT_X_DIR ? L6470_FWD : L6470_REV);
-      #else
-        WRITE(X_DIR_PIN, !INVERT_X_DIR);
-      #endif        
-      count_direction[X_AXIS]=1;
-    }
-    if((out_bits & (1<<Y_AXIS))!=0){
-      #if defined(Y_L6470_CS_PIN) && (Y_L6470_CS_PIN > -1)
-		l6470_y.setDir(INVERT_Y_DIR ? L6470_REV : L6470_FWD);
-	  #else
-        WRITE(Y_DIR_PIN, INVERT_Y_DIR);
-	  #endif
-	  
-	  #ifdef Y_DUAL_STEPPER_DRIVERS
-		#if defined(X_L6470_CS_PIN) && (X_L6470_CS_PIN > -1)
-		  #error Not yet implemented for L6470 drivers
-		#endif
-	    WRITE(Y2_DIR_PIN, !(INVERT_Y_DIR == INVERT_Y2_VS_Y_DIR));
-	  #endif
-	  
-      count_direction[Y_AXIS]=-1;
-    }
-    else{
-      #if defined(Y_L6470_CS_PIN) && (Y_L6470_CS_PIN > -1)
-		l6470_y.setDir(INVERT_Y_DIR ? L6470_FWD : L6470_REV);
-	  #else
-		WRITE(Y_DIR_PIN, !INVERT_Y_DIR);
-	  #endif
-
-	  #ifdef Y_DUAL_STEPPER_DRIVERS
-	    WRITE(Y2_DIR_PIN, (INVERT_Y_DIR == INVERT_Y2_VS_Y_DIR));
-	  #endif
-	  
-      count_direction[Y_AXIS]=1;
-    }
-
-    // Set direction en check limit switches
+    // Directions were set by st_load_block(); check the limit switches
+    #ifndef X_ENDSTOP_INTERRUPT
     #ifndef COREXY
     if ((out_bits & (1<<X_AXIS)) != 0) {   // stepping along -X axis
     #else
@@ -673,6 +1737,9 @@ ISR(TIMER1_COMPA_vect)
       }
     }
 
+    #endif // !X_ENDSTOP_INTERRUPT
+
+    #ifndef Y_ENDSTOP_INTERRUPT
     #ifndef COREXY
     if ((out_bits & (1<<Y_AXIS)) != 0) {   // -direction
     #else
@@ -705,22 +1772,10 @@ ISR(TIMER1_COMPA_vect)
         #endif
       }
     }
+    #endif // !Y_ENDSTOP_INTERRUPT
 
+    #ifndef Z_ENDSTOP_INTERRUPT
     if ((out_bits & (1<<Z_AXIS)) != 0) {   // -direction
-      #if defined(Z_L6470_CS_PIN) && (Z_L6470_CS_PIN > -1)
-		l6470_z.setDir(INVERT_Z_DIR ? L6470_REV : L6470_FWD);
-	  #else
-		WRITE(Z_DIR_PIN,INVERT_Z_DIR);
-      #endif
-
-      #ifdef Z_DUAL_STEPPER_DRIVERS
-        #if defined(Z_L6470_CS_PIN) && (Z_L6470_CS_PIN > -1)
-		  #error Not yet implemented for the L6470 driver
-		#endif
-        WRITE(Z2_DIR_PIN,INVERT_Z_DIR);
-      #endif
-
-      count_direction[Z_AXIS]=-1;
       CHECK_ENDSTOPS
       {
         #if defined(Z_MIN_PIN) && Z_MIN_PIN > -1
@@ -735,17 +1790,6 @@ ISR(TIMER1_COMPA_vect)
       }
     }
     else { // +direction
-     #if defined(Z_L6470_CS_PIN) && (Z_L6470_CS_PIN > -1)
-		l6470_z.setDir(INVERT_Z_DIR ? L6470_FWD : L6470_REV);
-	  #else
-		WRITE(Z_DIR_PIN,!INVERT_Z_DIR);
-	  #endif
-
-      #ifdef Z_DUAL_STEPPER_DRIVERS
-        WRITE(Z2_DIR_PIN,!INVERT_Z_DIR);
-      #endif
-
-      count_direction[Z_AXIS]=1;
       CHECK_ENDSTOPS
       {
         #if defined(Z_MAX_PIN) && Z_MAX_PIN > -1
@@ -759,17 +1803,24 @@ ISR(TIMER1_COMPA_vect)
         #endif
       }
     }
-
-    #ifndef ADVANCE
-      if ((out_bits & (1<<E_AXIS)) != 0) {  // -direction
-        REV_E_DIR();
-        count_direction[E_AXIS]=-1;
-      }
-      else { // +direction
-        NORM_E_DIR();
-        count_direction[E_AXIS]=1;
+    #endif // !Z_ENDSTOP_INTERRUPT
+
+    #ifdef ENDSTOP_INTERRUPTS
+      // Endstops with a pin interrupt have already latched their position; a latch
+      // from the block start is sampled again at the next interrupt, not this one
+      if (endstop_latched && step_events_completed != 0 && endstops_confirm_latched()) {
+        step_events_completed = current_block->step_event_count;
+        #ifdef STEPPER_ISR_PROFILE
+          isr_path = ISR_PATH_ENDSTOP;
+        #endif
       }
-    #endif //!ADVANCE
+    #endif
+
+
+    #ifdef INDEPENDENT_AXIS_TIMING
+      // Pulses of the last interval that compare B did not get to
+      phase_flush();
+    #endif
 
     #if USE_L6470 == 1
     // Reduce step_loops_shift if it would make us step too far
@@ -797,110 +1848,29 @@ ISR(TIMER1_COMPA_vect)
       }
       #endif //ADVANCE
 
-        counter_x += current_block->steps_x;
-        if (counter_x > 0) {
-        #ifdef DUAL_X_CARRIAGE
-          if (extruder_duplication_enabled){
-            WRITE(X_STEP_PIN, !INVERT_X_STEP_PIN);
-            WRITE(X2_STEP_PIN, !INVERT_X_STEP_PIN);
-          }
-          else {
-            if (current_block->active_extruder != 0)
-              WRITE(X2_STEP_PIN, !INVERT_X_STEP_PIN);
-            else
-              WRITE(X_STEP_PIN, !INVERT_X_STEP_PIN);
-          }
-        #elif defined(X_L6470_CS_PIN) && (X_L6470_CS_PIN > -1)
-		  busy_count = 0;
-		  while ((digitalRead(X_L6470_BSY_PIN) == LOW)  && (++busy_count < 100)) ;
-		  l6470_x.move(X_L6470_NSTEPS << step_loops_shift);
-		#else
-          WRITE(X_STEP_PIN, !INVERT_X_STEP_PIN);
-        #endif        
-          counter_x -= current_block->step_event_count;
-          count_position[X_AXIS]+=count_direction[X_AXIS];   
-        #ifdef DUAL_X_CARRIAGE
-          if (extruder_duplication_enabled){
-            WRITE(X_STEP_PIN, INVERT_X_STEP_PIN);
-            WRITE(X2_STEP_PIN, INVERT_X_STEP_PIN);
-          }
-          else {
-            if (current_block->active_extruder != 0)
-              WRITE(X2_STEP_PIN, INVERT_X_STEP_PIN);
-            else
-              WRITE(X_STEP_PIN, INVERT_X_STEP_PIN);
-          }
-        #elif !defined(X_L6470_CS_PIN) || (X_L6470_CS_PIN <= -1)
-          WRITE(X_STEP_PIN, INVERT_X_STEP_PIN);
-        #endif
-        }
-
-        counter_y += current_block->steps_y;
-        if (counter_y > 0) {
-          #if defined(Y_L6470_CS_PIN) && (Y_L6470_CS_PIN > -1)
-			busy_count = 0;
-			while ((digitalRead(Y_L6470_BSY_PIN) == LOW)  && (++busy_count < 100)) ;
-			l6470_y.move(Y_L6470_NSTEPS << step_loops_shift);
-          #else
-            WRITE(Y_STEP_PIN, !INVERT_Y_STEP_PIN);
-		  #endif
-
-		  #ifdef Y_DUAL_STEPPER_DRIVERS
-			WRITE(Y2_STEP_PIN, !INVERT_Y_STEP_PIN);
-		  #endif
-		  
-          counter_y -= current_block->step_event_count;
-          count_position[Y_AXIS]+=count_direction[Y_AXIS];
-          #if !defined(Y_L6470_CS_PIN) || (Y_L6470_CS_PIN <= -1)
-            WRITE(Y_STEP_PIN, INVERT_Y_STEP_PIN);
-		  #endif
-
-		  #ifdef Y_DUAL_STEPPER_DRIVERS
-			WRITE(Y2_STEP_PIN, INVERT_Y_STEP_PIN);
-		  #endif
-        }
-
-      counter_z += current_block->steps_z;
-      if (counter_z > 0) {
-          #if defined(Z_L6470_CS_PIN) && (Z_L6470_CS_PIN > -1)
-		    busy_count = 0;
-		    while ((digitalRead(Z_L6470_BSY_PIN) == LOW)  && (++busy_count < 100)) ;
-			// Bill: l6470_z.softStop();
-			l6470_z.move(Z_L6470_NSTEPS << step_loops_shift);
-          #else
-			WRITE(Z_STEP_PIN, !INVERT_Z_STEP_PIN);
-          #endif
-
-        #ifdef Z_DUAL_STEPPER_DRIVERS
-          WRITE(Z2_STEP_PIN, !INVERT_Z_STEP_PIN);
-        #endif
-
-        counter_z -= current_block->step_event_count;
-        count_position[Z_AXIS]+=count_direction[Z_AXIS];
-        #if !defined(Z_L6470_CS_PIN) || (Z_L6470_CS_PIN <= -1)
-          WRITE(Z_STEP_PIN, INVERT_Z_STEP_PIN);
-		#endif
-        
-        #ifdef Z_DUAL_STEPPER_DRIVERS
-          WRITE(Z2_STEP_PIN, INVERT_Z_STEP_PIN);
-        #endif
+      #ifdef INDEPENDENT_AXIS_TIMING
+      if (step_loops == 1) {
+        if (block_axes & (1<<X_AXIS)) phase_axis<X_AXIS>(counter_x, current_block->steps_x);
+        if (block_axes & (1<<Y_AXIS)) phase_axis<Y_AXIS>(counter_y, current_block->steps_y);
+        if (block_axes & (1<<Z_AXIS)) phase_axis<Z_AXIS>(counter_z, current_block->steps_z);
+        #ifndef ADVANCE
+        if (block_axes & (1<<E_AXIS)) phase_axis<E_AXIS>(counter_e, current_block->steps_e);
+        #endif //!ADVANCE
+      }
+      else
+      #endif
+      {
+        if (block_axes & (1<<X_AXIS)) step_axis<x_driver, X_AXIS>(counter_x, current_block->steps_x);
+        if (block_axes & (1<<Y_AXIS)) step_axis<y_driver, Y_AXIS>(counter_y, current_block->steps_y);
+        if (block_axes & (1<<Z_AXIS)) step_axis<z_driver, Z_AXIS>(counter_z, current_block->steps_z);
+        #ifndef ADVANCE
+        if (block_axes & (1<<E_AXIS)) step_axis<e_driver, E_AXIS>(counter_e, current_block->steps_e);
+        #endif //!ADVANCE
       }
-
-      #ifndef ADVANCE
-        counter_e += current_block->steps_e;
-        if (counter_e > 0) {
-          WRITE_E_STEP(!INVERT_E_STEP_PIN);
-          counter_e -= current_block->step_event_count;
-          count_position[E_AXIS]+=count_direction[E_AXIS];
-          #if !defined(USE_L6470) || (USE_L6470 == 0)
-            WRITE_E_STEP(INVERT_E_STEP_PIN);
-		  #endif
-        }
-      #endif //!ADVANCE
 #if USE_L6470 == 1
 	  step_events_completed += 1 << step_loops_shift;
 #else
-	  step_events_completed += step_loops;
+	  step_events_completed += 1;
       if(step_events_completed >= current_block->step_event_count) break;
 #endif
     }
@@ -908,18 +1878,23 @@ ISR(TIMER1_COMPA_vect)
     unsigned short timer;
     unsigned short step_rate;
     if (step_events_completed <= (unsigned long int)current_block->accelerate_until) {
+      #ifdef STEPPER_RAMP_TABLE
+      if (!ramp_lookup(acc_step_rate, timer))
+      #endif
+      {
+        MultiU24X24toH16(acc_step_rate, acceleration_time, current_block->acceleration_rate);
+        acc_step_rate += current_block->initial_rate;
 
-      MultiU24X24toH16(acc_step_rate, acceleration_time, current_block->acceleration_rate);
-      acc_step_rate += current_block->initial_rate;
-
-      // upper limit
-      if(acc_step_rate > current_block->nominal_rate)
-        acc_step_rate = current_block->nominal_rate;
+        // upper limit
+        if(acc_step_rate > current_block->nominal_rate)
+          acc_step_rate = current_block->nominal_rate;
 
-      // step_rate to timer interval
-      timer = calc_timer(acc_step_rate);
+        // step_rate to timer interval
+        timer = calc_timer(acc_step_rate);
+      }
       OCR1A = timer;
       acceleration_time += timer;
+      ISR_PROFILE_PATH(ISR_PATH_ACCEL);
       #ifdef ADVANCE
 #if !defined(USE_L6470) || USE_L6470 == 0
 	  for(int8_t i=0; i < step_loops; i++) {
@@ -936,23 +1911,29 @@ ISR(TIMER1_COMPA_vect)
       #endif
     }
     else if (step_events_completed > (unsigned long int)current_block->decelerate_after) {
-      MultiU24X24toH16(step_rate, deceleration_time, current_block->acceleration_rate);
+      #ifdef STEPPER_RAMP_TABLE
+      if (!ramp_lookup(step_rate, timer))
+      #endif
+      {
+        MultiU24X24toH16(step_rate, deceleration_time, current_block->acceleration_rate);
 
-      if(step_rate > acc_step_rate) { // Check step_rate stays positive
-        step_rate = current_block->final_rate;
-      }
-      else {
-        step_rate = acc_step_rate - step_rate; // Decelerate from aceleration end point.
-      }
+        if(step_rate > acc_step_rate) { // Check step_rate stays positive
+          step_rate = current_block->final_rate;
+        }
+        else {
+          step_rate = acc_step_rate - step_rate; // Decelerate from aceleration end point.
+        }
 
-      // lower limit
-      if(step_rate < current_block->final_rate)
-        step_rate = current_block->final_rate;
+        // lower limit
+        if(step_rate < current_block->final_rate)
+          step_rate = current_block->final_rate;
 
-      // step_rate to timer interval
-      timer = calc_timer(step_rate);
+        // step_rate to timer interval
+        timer = calc_timer(step_rate);
+      }
       OCR1A = timer;
       deceleration_time += timer;
+      ISR_PROFILE_PATH(ISR_PATH_DECEL);
       #ifdef ADVANCE
 	  #if !defined(USE_L6470) || USE_L6470 == 0
         for(int8_t i=0; i < step_loops; i++) {
@@ -969,6 +1950,7 @@ ISR(TIMER1_COMPA_vect)
     }
     else {
       OCR1A = OCR1A_nominal;
+      ISR_PROFILE_PATH(ISR_PATH_CRUISE);
       // ensure we're running at the correct step rate, even if we just came off an acceleration
 #if !defined(USE_L6470) || USE_L6470 == 0
       step_loops = step_loops_nominal;
@@ -977,12 +1959,28 @@ ISR(TIMER1_COMPA_vect)
 #endif
     }
 
+    #ifdef STEPPER_RAMP_TABLE
+      ramp_tick++;
+    #endif
+
+    #ifdef INDEPENDENT_AXIS_TIMING
+      if (phase_due) phase_schedule(OCR1A);
+    #endif
+
     // If current block is finished, reset pointer
     if (step_events_completed >= current_block->step_event_count) {
+      #ifdef INDEPENDENT_AXIS_TIMING
+        // The next block may turn the directions around
+        phase_flush();
+      #endif
       current_block = NULL;
       plan_discard_current_block();
     }
   }
+  #ifdef STEPPER_ISR_PROFILE
+    if (!isr_was_hit && (endstop_x_hit || endstop_y_hit || endstop_z_hit)) isr_path = ISR_PATH_ENDSTOP;
+    isr_profile_record(isr_path, isr_entry);
+  #endif
 }
 
 #ifdef ADVANCE
@@ -1052,6 +2050,7 @@ void st_init()
 
   #if defined(USE_L6470) && (USE_L6470 != 0)
   init_L6470_drivers();
+  l6470_measure_spi();
   #endif
 
   //Initialize Dir Pins
@@ -1171,6 +2170,10 @@ void st_init()
     #endif
   #endif
 
+  #ifdef ENDSTOP_INTERRUPTS
+    endstop_interrupts_init();
+  #endif
+
 
   //Initialize Step Pins
   #if defined(X_STEP_PIN) && (X_STEP_PIN > -1)
@@ -1272,6 +2275,9 @@ void st_set_position(const long &x, const long &y, const long &z, const long &e)
   count_position[Z_AXIS] = z;
   count_position[E_AXIS] = e;
   CRITICAL_SECTION_END;
+  #ifdef L6470_STEP_VERIFY
+    st_l6470_verify_resync();
+  #endif
 }
 
 void st_set_e_position(const long &e)
@@ -1312,6 +2318,14 @@ void finishAndDisableSteppers()
 void quickStop()
 {
   DISABLE_STEPPER_DRIVER_INTERRUPT();
+  #ifdef INDEPENDENT_AXIS_TIMING
+  {
+    // The queued pulses are already counted in count_position
+    CRITICAL_SECTION_START;
+    if (current_block != NULL) phase_flush();
+    CRITICAL_SECTION_END;
+  }
+  #endif
   while(blocks_queued())
     plan_discard_current_block();
   current_block = NULL;
@@ -50,10 +50,18 @@
 #elif EXTRUDERS > 1
 #error Not yet implemented for L6470 drivers
 #else
-#define WRITE_E_STEP(v) { \
-		busy_count = 0;													\
-		while((digitalRead(X_L6470_BSY_PIN) == LOW)  && (++busy_count < 100)) ; \
-		l6470_e0.move(E0_L6470_NSTEPS << step_loops_shift); }
+// Wait (briefly) for an L6470 to finish its last MOVE
+#ifdef STEPPER_ISR_PROFILE
+  extern unsigned short isr_prof_bsy_timeouts;
+  #define L6470_WAIT_BSY(pin) { busy_count = 0; \
+		while((digitalRead(pin) == LOW)  && (++busy_count < 100)) ; \
+		if (busy_count >= 100) isr_prof_bsy_timeouts++; }
+#else
+  #define L6470_WAIT_BSY(pin) { busy_count = 0; \
+		while((digitalRead(pin) == LOW)  && (++busy_count < 100)) ; }
+#endif
+// Hand E0 n steps in one MOVE
+#define WRITE_E_STEPS(n) { L6470_WAIT_BSY(E0_L6470_BSY_PIN); l6470_e0.move(E0_L6470_NSTEPS * (n)); }
   #define NORM_E_DIR() l6470_e0.setDir(INVERT_E0_DIR ? L6470_FWD : L6470_REV)
   #define REV_E_DIR()  l6470_e0.setDir(INVERT_E0_DIR ? L6470_REV : L6470_REV)
 #endif
@@ -63,6 +71,25 @@
 extern bool abort_on_endstop_hit;
 #endif
 
+// Endstops that are sensed by a pin interrupt rather than polled by the stepper ISR
+#ifdef ENDSTOP_INTERRUPTS
+  #if defined(X_STOP_INT) || defined(X_STOP_PCINT)
+    #define X_ENDSTOP_INTERRUPT
+  #endif
+  #if defined(Y_STOP_INT) || defined(Y_STOP_PCINT)
+    #define Y_ENDSTOP_INTERRUPT
+  #endif
+  #if defined(Z_STOP_INT) || defined(Z_STOP_PCINT)
+    #define Z_ENDSTOP_INTERRUPT
+  #endif
+  #if defined(COREXY) && (defined(X_ENDSTOP_INTERRUPT) || defined(Y_ENDSTOP_INTERRUPT))
+    #error ENDSTOP_INTERRUPTS is not implemented for COREXY X/Y endstops
+  #endif
+  #if defined(DUAL_X_CARRIAGE) && defined(X_ENDSTOP_INTERRUPT)
+    #error ENDSTOP_INTERRUPTS is not implemented for DUAL_X_CARRIAGE
+  #endif
+#endif
+
 // Initialize and start the stepper motor subsystem
 void st_init();
 
@@ -114,6 +141,33 @@ void dac_commit_eeprom();
 void microstep_init();
 void microstep_readings();
 
+#ifdef POWER_LOSS_RESUME
+// The last SD command whose moves are all done, and the positions they left the axes
+// at; true if it is newer than the last call returned
+bool st_checkpoint(plan_resume_t &resume, long *steps);
+#endif
+
+#ifdef STEPPER_RAMP_TABLE
+// Work out the next ramp intervals of the current block; call from the main loop
+void st_ramp_fill();
+#endif
+
+#ifdef STEPPER_ISR_PROFILE
+// Paths through the stepper ISR that are profiled separately
+#define ISR_PATH_IDLE         0
+#define ISR_PATH_BLOCK_START  1
+#define ISR_PATH_ACCEL        2
+#define ISR_PATH_CRUISE       3
+#define ISR_PATH_DECEL        4
+#define ISR_PATH_ENDSTOP      5
+#define ISR_PATHS             6
+#define ISR_PROFILE_BUCKETS   8
+
+void st_isr_profile_reset();
+void st_isr_profile_report();
+unsigned short st_isr_load();  // busy time since the last call, in 1/100 %
+#endif
+
 #ifdef BABYSTEPPING
   void babystep(const uint8_t axis,const bool direction); // perform a short step with a single stepper motor, outside of any convention
 #endif
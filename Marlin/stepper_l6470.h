@@ -29,4 +29,47 @@ extern L6470 l6470_e1;
 extern L6470 l6470_e2;
 #endif
 
+// Highest stepper interrupt rate at which MOVEs to the given number of axes
+// stay within L6470_SPI_BUDGET
+unsigned short st_l6470_max_isr_rate(uint8_t axes);
+
+#ifdef L6470_STEP_VERIFY
+extern bool l6470_verify_enabled;
+extern unsigned long l6470_verify_interval;
+extern long l6470_verify_tolerance;
+extern uint8_t l6470_verify_action;
+extern long l6470_drift[3];
+
+void st_l6470_verify();         // compare ABS_POS with count_position[]; call from the main loop
+void st_l6470_verify_resync();  // take the current positions as the new reference
+void st_l6470_verify_report();
+#endif
+
+#ifdef L6470_HEALTH_MONITOR
+// Events decoded from the STATUS register, in the order they are counted
+#define L6470_EV_UVLO       0
+#define L6470_EV_TH_WRN     1
+#define L6470_EV_TH_SD      2
+#define L6470_EV_OCD        3
+#define L6470_EV_STALL_A    4
+#define L6470_EV_STALL_B    5
+#define L6470_EV_NOTPERF    6
+#define L6470_EV_WRONG_CMD  7
+#define L6470_EVENTS        8
+
+typedef struct {
+  uint16_t status;                      // STATUS as last read
+  uint16_t count[L6470_EVENTS];         // events seen since the last reset
+  unsigned long last_ms[L6470_EVENTS];  // millis() of the most recent event
+} l6470_health_t;
+
+extern unsigned long l6470_health_interval;
+extern uint8_t l6470_health_action;
+extern l6470_health_t l6470_health[4];
+
+void st_l6470_health();         // poll STATUS of every driver; call from the main loop
+void st_l6470_health_reset();
+void st_l6470_health_report();
+#endif
+
 #endif
@@ -35,7 +35,7 @@ void manage_heater(); //it is critical that this is called periodically.
 // do not use these routines and variables outside of temperature.cpp
 extern int target_temperature[EXTRUDERS];  
 extern float current_temperature[EXTRUDERS];
-#ifdef SHOW_TEMP_ADC_VALUES
+#if defined(SHOW_TEMP_ADC_VALUES) || defined(BINARY_TELEMETRY)
   extern int current_temperature_raw[EXTRUDERS];
   extern int current_temperature_bed_raw;
 #endif